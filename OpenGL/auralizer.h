@@ -0,0 +1,199 @@
+#ifndef AURALIZER_H
+#define AURALIZER_H
+
+#include <stdio.h>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "bands.h"
+#include "histogram.h"
+#include "random.h"
+#include "fft.h"
+#include "convolver.h"
+#include "wav.h"
+#include "parallel.h"
+#include "profiler.h"
+
+/**
+ * @class Auralizer
+ * @brief Auralización de los receptores: respuesta al impulso de presión y convolución de un WAV mono.
+ * @details La respuesta de presión se sintetiza a partir del histograma energía-tiempo: en cada banda, ruido blanco
+ * de varianza unidad se modula con la envolvente sqrt(E / (ancho · fs)) del intervalo correspondiente y se filtra
+ * con un paso banda de octava en el dominio de la frecuencia, compensando la fracción de potencia que conserva el
+ * filtro. Las bandas se suman en el dominio de la frecuencia, así que basta una transformada inversa por receptor.
+ * Todas las respuestas se escalan con el mismo factor para que la de mayor energía tenga energía unidad y se
+ * conserven los niveles relativos entre receptores.
+ *
+ * La convolución se hace por bloques con un Convolver por receptor, leyendo y escribiendo los archivos de forma
+ * incremental; cada receptor es una tarea independiente repartida entre los hilos.
+ */
+class Auralizer {
+public:
+	int sampleRate;								/* Frecuencia de muestreo en Hz */
+	int blockSize;								/* Muestras por bloque de la convolución */
+	uint64_t seed;								/* Semilla del ruido de la síntesis */
+	std::vector<std::vector<float>> responses;	/* Respuesta al impulso de presión de cada receptor */
+
+	/**
+	 * @brief Constructor de la clase Auralizer.
+	 * @param rate Frecuencia de muestreo en Hz
+	 * @param block Muestras por bloque de la convolución (potencia de dos)
+	 * @param s Semilla del ruido de la síntesis
+	 */
+	Auralizer(int rate, int block, uint64_t s) : sampleRate(rate), blockSize(block), seed(s) {}
+
+	/**
+	 * @brief Sintetiza las respuestas al impulso de presión de todos los receptores.
+	 * @param histograms Histogramas energía-tiempo de los receptores
+	 * @param threads Número de hilos
+	 */
+	void build(const std::vector<Histogram>& histograms, int threads) {
+		responses.assign(histograms.size(), std::vector<float>());
+		if (histograms.empty()) {
+			return;
+		}
+
+		// La duración es la del último intervalo con energía en algún receptor
+		int lastBin = 0;
+		for (size_t r = 0; r < histograms.size(); r++) {
+			for (int i = histograms[r].numBins - 1; i >= lastBin; i--) {
+				if (nonZero(histograms[r], i)) {
+					lastBin = i + 1;
+					break;
+				}
+			}
+		}
+		long long length = (long long)ceil(lastBin * histograms[0].binWidth * sampleRate);
+		if (length <= 0) {
+			return;
+		}
+
+		// Transformada con margen para que el filtrado circular no pliegue la cola sobre el principio
+		FFT fft = FFT(2 * FFT::nextPowerOfTwo(length));
+		std::vector<double> energies(histograms.size(), 0.0);
+		parallelFor((int)histograms.size(), threads, [&](int r, int) {
+			PROFILE_ZONE("Auralizer::synthesize");
+			responses[r] = synthesize(fft, histograms[r], (int)length, Random::forStream(seed, r));
+			double e = 0;
+			for (size_t i = 0; i < responses[r].size(); i++) {
+				e += (double)responses[r][i] * responses[r][i];
+			}
+			energies[r] = e;
+		});
+
+		double peak = 0;
+		for (size_t r = 0; r < energies.size(); r++) {
+			peak = energies[r] > peak ? energies[r] : peak;
+		}
+		float scale = peak > 0 ? (float)(1.0 / sqrt(peak)) : 1.0f;
+		for (size_t r = 0; r < responses.size(); r++) {
+			for (size_t i = 0; i < responses[r].size(); i++) {
+				responses[r][i] *= scale;
+			}
+		}
+	}
+
+	/**
+	 * @brief Sintetiza la respuesta al impulso de presión de un histograma.
+	 * @param fft Transformada de al menos 2·length puntos
+	 * @param h Histograma energía-tiempo
+	 * @param length Muestras de la respuesta
+	 * @param rng Generador del ruido
+	 */
+	std::vector<float> synthesize(const FFT& fft, const Histogram& h, int length, Random rng) const {
+		int N = fft.size;
+		std::vector<std::complex<float>> total(N, std::complex<float>(0, 0));
+		std::vector<std::complex<float>> buffer(N);
+		double nyquist = sampleRate / 2.0;
+		double samplesPerBin = h.binWidth * sampleRate;
+
+		for (int b = 0; b < NUM_BANDS; b++) {
+			double lo = b == 0 ? 0.0 : BAND_FREQUENCIES[b] / sqrt(2.0);
+			double hi = b == NUM_BANDS - 1 ? nyquist : fmin(nyquist, BAND_FREQUENCIES[b] * sqrt(2.0));
+			if (lo >= hi) {
+				continue;
+			}
+			double compensation = sqrt(nyquist / (hi - lo));
+
+			// Ruido uniforme de varianza unidad modulado por la envolvente de la banda
+			for (int i = 0; i < N; i++) {
+				float v = 0;
+				if (i < length) {
+					int bin = (int)(i / samplesPerBin);
+					double e = bin < h.numBins ? h.at(bin, b) : 0.0;
+					v = (float)((2.0 * rng.nextDouble() - 1.0) * sqrt(3.0 * e / samplesPerBin) * compensation);
+				}
+				buffer[i] = std::complex<float>(v, 0.0f);
+			}
+			fft.forward(buffer.data());
+
+			int kLo = (int)ceil(lo * N / sampleRate), kHi = (int)ceil(hi * N / sampleRate);
+			for (int k = kLo; k < kHi && k <= N / 2; k++) {
+				total[k] += buffer[k];
+				if (k > 0 && k < N / 2) total[N - k] += buffer[N - k];
+			}
+		}
+
+		fft.inverse(total.data());
+		std::vector<float> response(length);
+		for (int i = 0; i < length; i++) {
+			response[i] = total[i].real();
+		}
+		return response;
+	}
+
+	/**
+	 * @brief Convoluciona un WAV con la respuesta de cada receptor y guarda un WAV por receptor.
+	 * @details La salida dura lo que la entrada más la respuesta menos una muestra.
+	 * @param input Archivo WAV de entrada (se mezcla a mono)
+	 * @param prefix Prefijo de los archivos de salida; se les añade el índice del receptor
+	 * @param threads Número de hilos
+	 * @return Muestras de entrada procesadas en total (entre todos los receptores)
+	 */
+	long long run(const char* input, const char* prefix, int threads) const {
+		std::vector<long long> processed(responses.size(), 0);
+		parallelFor((int)responses.size(), threads, [&](int r, int) {
+			PROFILE_ZONE("Auralizer::convolve");
+			WavReader reader(input);
+			if (!reader.valid()) {
+				return;
+			}
+			char filename[256];
+			snprintf(filename, sizeof(filename), "%s_%d.wav", prefix, r);
+			WavWriter writer;
+			if (!writer.open(filename, reader.sampleRate)) {
+				return;
+			}
+
+			Convolver convolver = Convolver(responses[r], blockSize);
+			std::vector<float> in(blockSize), out(blockSize);
+			long long pending = reader.frames + (long long)responses[r].size() - 1;
+			while (pending > 0) {
+				int got = reader.read(in.data(), blockSize);
+				std::fill(in.begin() + got, in.end(), 0.0f);
+				convolver.process(in.data(), out.data());
+				int count = (int)(pending < blockSize ? pending : blockSize);
+				writer.write(out.data(), count);
+				pending -= count;
+				processed[r] += got;
+			}
+		});
+
+		long long sum = 0;
+		for (size_t r = 0; r < processed.size(); r++) {
+			sum += processed[r];
+		}
+		return sum;
+	}
+
+private:
+	static bool nonZero(const Histogram& h, int bin) {
+		for (int b = 0; b < NUM_BANDS; b++) {
+			if (h.at(bin, b) > 0) return true;
+		}
+		return false;
+	}
+};
+
+#endif // AURALIZER_H
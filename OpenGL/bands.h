@@ -0,0 +1,122 @@
+#ifndef BANDS_H
+#define BANDS_H
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+constexpr int NUM_BANDS = 8; /* Número de bandas de octava */
+const float BAND_FREQUENCIES[NUM_BANDS] = { 63, 125, 250, 500, 1000, 2000, 4000, 8000 }; /* Frecuencias centrales en Hz */
+
+/**
+ * @class Bands
+ * @brief Vector de energía (o de coeficientes) por banda de octava.
+ * @details Las ocho bandas caben en un registro AVX (o en dos SSE), así que atenuar las ocho bandas cuesta una sola
+ * multiplicación vectorial.
+ */
+class Bands {
+public:
+	float v[NUM_BANDS]; /* Valor de cada banda */
+
+	Bands() {
+		for (int i = 0; i < NUM_BANDS; i++) v[i] = 0;
+	}
+
+	/**
+	 * @brief Constructor con el mismo valor en todas las bandas.
+	 * @param f Valor de todas las bandas
+	 */
+	explicit Bands(float f) {
+		for (int i = 0; i < NUM_BANDS; i++) v[i] = f;
+	}
+
+	/**
+	 * @brief Constructor a partir de un arreglo de NUM_BANDS valores.
+	 * @param f Valores de las bandas
+	 */
+	explicit Bands(const float* f) {
+		for (int i = 0; i < NUM_BANDS; i++) v[i] = f[i];
+	}
+
+	float& operator[](int i) { return v[i]; }
+	float operator[](int i) const { return v[i]; }
+
+	/**
+	 * @brief Producto banda a banda.
+	 * @param b Bandas a multiplicar
+	 * @return Bandas resultado
+	 */
+	Bands operator*(const Bands& b) const {
+		Bands r;
+#if defined(__AVX__)
+		_mm256_storeu_ps(r.v, _mm256_mul_ps(_mm256_loadu_ps(v), _mm256_loadu_ps(b.v)));
+#elif defined(__SSE2__) || defined(_M_X64)
+		_mm_storeu_ps(r.v, _mm_mul_ps(_mm_loadu_ps(v), _mm_loadu_ps(b.v)));
+		_mm_storeu_ps(r.v + 4, _mm_mul_ps(_mm_loadu_ps(v + 4), _mm_loadu_ps(b.v + 4)));
+#else
+		for (int i = 0; i < NUM_BANDS; i++) r.v[i] = v[i] * b.v[i];
+#endif
+		return r;
+	}
+
+	/**
+	 * @brief Producto por un escalar.
+	 * @param f Escalar
+	 * @return Bandas resultado
+	 */
+	Bands operator*(float f) const {
+		return *this * Bands(f);
+	}
+
+	/**
+	 * @brief Suma banda a banda.
+	 * @param b Bandas a sumar
+	 * @return Bandas resultado
+	 */
+	Bands operator+(const Bands& b) const {
+		Bands r;
+		for (int i = 0; i < NUM_BANDS; i++) r.v[i] = v[i] + b.v[i];
+		return r;
+	}
+
+	Bands& operator*=(const Bands& b) {
+		*this = *this * b;
+		return *this;
+	}
+
+	Bands& operator+=(const Bands& b) {
+		*this = *this + b;
+		return *this;
+	}
+
+	/**
+	 * @brief Devuelve 1 - valor en cada banda (por ejemplo, reflectancia a partir de absorción).
+	 */
+	Bands complement() const {
+		Bands r;
+		for (int i = 0; i < NUM_BANDS; i++) r.v[i] = 1.0f - v[i];
+		return r;
+	}
+
+	/**
+	 * @brief Devuelve el valor medio de las bandas.
+	 */
+	float mean() const {
+		float sum = 0;
+		for (int i = 0; i < NUM_BANDS; i++) sum += v[i];
+		return sum / NUM_BANDS;
+	}
+
+	/**
+	 * @brief Devuelve el valor máximo de las bandas.
+	 */
+	float peak() const {
+		float m = v[0];
+		for (int i = 1; i < NUM_BANDS; i++) m = v[i] > m ? v[i] : m;
+		return m;
+	}
+};
+
+#endif // BANDS_H
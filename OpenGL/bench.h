@@ -0,0 +1,149 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <string>
+#include <vector>
+
+/*
+ * Contador de reservas de memoria del hilo actual. Con ENABLE_ALLOCATION_COUNT definido se sustituye el operator new
+ * global, así que este archivo solo debe incluirse desde una unidad de traducción (main.cpp). Es una opción solo para
+ * compilar las mediciones: sin ella el programa usa el operator new de la biblioteca y las reservas por operación
+ * valen NaN.
+ */
+thread_local long long allocationCount = 0;
+
+#ifdef ENABLE_ALLOCATION_COUNT
+
+const bool countingAllocations = true;
+
+void* operator new(size_t size) {
+	allocationCount++;
+	void* p = malloc(size ? size : 1);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	allocationCount++;
+	return malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept {
+	free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+	free(p);
+}
+
+#else
+
+const bool countingAllocations = false;
+
+#endif // ENABLE_ALLOCATION_COUNT
+
+/**
+ * @brief Resultado de una medición.
+ */
+struct BenchResult {
+	std::string name;			/* Nombre de la medición */
+	long long iterations;		/* Repeticiones medidas */
+	double nsPerOp;				/* Nanosegundos por operación */
+	double itemsPerSecond;		/* Operaciones por segundo */
+	double allocationsPerOp;	/* Reservas de memoria por operación */
+};
+
+/**
+ * @class Bench
+ * @brief Medición de microbenchmarks con número de repeticiones calibrado.
+ * @details Cada medición es una función que ejecuta un lote de `items` operaciones y devuelve un valor que se acumula
+ * en una variable volátil para que el compilador no elimine el trabajo. El número de repeticiones se duplica hasta
+ * que el lote dura al menos `minTime` segundos, tras una repetición de calentamiento. Los datos de entrada de cada
+ * medición deben generarse con semillas fijas para que los resultados sean comparables entre versiones.
+ */
+class Bench {
+public:
+	double minTime;						/* Duración mínima de cada medición en segundos */
+	std::vector<BenchResult> results;	/* Resultados en el orden en que se midieron */
+	volatile double sink;				/* Acumulador que mantiene vivos los resultados */
+
+	/**
+	 * @brief Constructor de la clase Bench.
+	 * @param t Duración mínima de cada medición en segundos
+	 */
+	explicit Bench(double t) : minTime(t), sink(0) {}
+
+	/**
+	 * @brief Mide una función.
+	 * @param name Nombre de la medición
+	 * @param items Operaciones que ejecuta cada llamada a la función
+	 * @param op Función a medir: `double()`
+	 */
+	template <typename Op>
+	void run(const std::string& name, long long items, Op op) {
+		sink = sink + op();
+
+		long long iterations = 1;
+		double elapsed = 0;
+		long long allocations = 0;
+		while (true) {
+			long long before = allocationCount;
+			auto start = std::chrono::steady_clock::now();
+			double acc = 0;
+			for (long long i = 0; i < iterations; i++) {
+				acc += op();
+			}
+			elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			allocations = allocationCount - before;
+			sink = sink + acc;
+			if (elapsed >= minTime || iterations >= (1LL << 40)) {
+				break;
+			}
+			iterations *= 2;
+		}
+
+		BenchResult r;
+		r.name = name;
+		r.iterations = iterations;
+		double ops = (double)iterations * items;
+		r.nsPerOp = elapsed * 1e9 / ops;
+		r.itemsPerSecond = ops / elapsed;
+		r.allocationsPerOp = countingAllocations ? allocations / ops : std::numeric_limits<double>::quiet_NaN();
+		results.push_back(r);
+
+		printf("%-44s %14.1f ns/op %14.0f items/s %10.2f allocs/op\n", name.c_str(), r.nsPerOp, r.itemsPerSecond, r.allocationsPerOp);
+		fflush(stdout);
+	}
+
+	/**
+	 * @brief Guarda los resultados en un archivo CSV con cabecera.
+	 * @param filename Nombre del archivo
+	 */
+	void exportCSV(const char* filename) const {
+		FILE* file;
+		if (fopen_s(&file, filename, "w") != 0) {
+			perror("Error al abrir el archivo");
+			return;
+		}
+
+		fprintf(file, "name,iterations,nsPerOp,itemsPerSecond,allocationsPerOp\n");
+		for (size_t i = 0; i < results.size(); i++) {
+			const BenchResult& r = results[i];
+			fprintf(file, "%s,%lld,%.3f,%.3f,%.6f\n", r.name.c_str(), r.iterations, r.nsPerOp, r.itemsPerSecond, r.allocationsPerOp);
+		}
+
+		fclose(file);
+	}
+};
+
+#endif // BENCH_H
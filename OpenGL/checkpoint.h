@@ -0,0 +1,315 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+// glad.h ya define APIENTRY y windows.h lo vuelve a definir sin comprobarlo: se aparta la definición de glad mientras
+// se incluye windows.h y se recupera después
+#pragma push_macro("APIENTRY")
+#undef APIENTRY
+#include <io.h>
+#include <windows.h>
+#undef APIENTRY
+#pragma pop_macro("APIENTRY")
+#else
+#include <unistd.h>
+#endif
+
+/**
+ * @class Checkpoint
+ * @brief Estado binario de una ejecución: los valores se copian tal cual en memoria, en el orden en que se guardan, y
+ * se leen en el mismo orden.
+ * @details En disco el estado va precedido de una cabecera con una marca, la versión del formato, la huella de la
+ * configuración de la ejecución, la longitud y un resumen FNV-1a de los datos. Un archivo truncado, de otra versión o
+ * de otra configuración se rechaza.
+ */
+class Checkpoint {
+public:
+	static const uint32_t MAGIC = 0x4b434e42;	/* "BNCK" */
+	static const uint32_t VERSION = 1;			/* Versión del formato */
+
+	std::vector<char> data;	/* Estado serializado */
+	size_t offset;			/* Posición de lectura */
+	bool ok;				/* Indica si todas las lecturas han encontrado datos suficientes */
+
+	Checkpoint() : offset(0), ok(true) {}
+
+	/**
+	 * @brief Guarda un valor de tipo trivialmente copiable.
+	 */
+	template <typename T>
+	void put(const T& value) {
+		const char* bytes = (const char*)&value;
+		data.insert(data.end(), bytes, bytes + sizeof(T));
+	}
+
+	/**
+	 * @brief Guarda los `count` primeros elementos de un vector, precedidos de su número.
+	 */
+	template <typename T>
+	void putVector(const std::vector<T>& values, size_t count) {
+		put((uint64_t)count);
+		const char* bytes = (const char*)values.data();
+		data.insert(data.end(), bytes, bytes + count * sizeof(T));
+	}
+
+	template <typename T>
+	void putVector(const std::vector<T>& values) {
+		putVector(values, values.size());
+	}
+
+	/**
+	 * @brief Lee un valor guardado con put.
+	 * @return false si no quedan datos suficientes
+	 */
+	template <typename T>
+	bool get(T& value) {
+		if (!ok || data.size() - offset < sizeof(T)) {
+			ok = false;
+			return false;
+		}
+		memcpy(&value, &data[offset], sizeof(T));
+		offset += sizeof(T);
+		return true;
+	}
+
+	/**
+	 * @brief Lee un vector guardado con putVector. Si el vector es más pequeño crece; si es más grande conserva sus
+	 * elementos a partir de los leídos.
+	 * @return Número de elementos leídos
+	 */
+	template <typename T>
+	size_t getVector(std::vector<T>& values) {
+		uint64_t count = 0;
+		if (!get(count) || (data.size() - offset) / sizeof(T) < count) {
+			ok = false;
+			return 0;
+		}
+		if (values.size() < count) {
+			values.resize((size_t)count);
+		}
+		if (count > 0) {
+			memcpy(values.data(), &data[offset], (size_t)count * sizeof(T));
+		}
+		offset += (size_t)count * sizeof(T);
+		return (size_t)count;
+	}
+
+	/**
+	 * @brief Escribe el estado con su cabecera y espera a que esté en disco.
+	 * @return false si no se ha podido escribir completo
+	 */
+	bool write(const char* filename, uint64_t fingerprint) const {
+		FILE* file;
+		if (fopen_s(&file, filename, "wb") != 0) {
+			perror("Error al abrir el archivo");
+			return false;
+		}
+		uint32_t magic = MAGIC, version = VERSION;
+		uint64_t length = data.size(), digest = hash(data.data(), data.size());
+		bool written = fwrite(&magic, sizeof(magic), 1, file) == 1 && fwrite(&version, sizeof(version), 1, file) == 1
+			&& fwrite(&fingerprint, sizeof(fingerprint), 1, file) == 1 && fwrite(&length, sizeof(length), 1, file) == 1
+			&& fwrite(&digest, sizeof(digest), 1, file) == 1 && fwrite(data.data(), 1, data.size(), file) == data.size();
+		written = fflush(file) == 0 && written;
+#ifdef _WIN32
+		written = _commit(_fileno(file)) == 0 && written;
+#else
+		written = fsync(fileno(file)) == 0 && written;
+#endif
+		return fclose(file) == 0 && written;
+	}
+
+	/**
+	 * @brief Lee un estado escrito con write.
+	 * @return false si el archivo no existe, está incompleto o es de otra versión o configuración
+	 */
+	bool read(const char* filename, uint64_t fingerprint) {
+		FILE* file;
+		if (fopen_s(&file, filename, "rb") != 0) {
+			return false;
+		}
+		uint32_t magic = 0, version = 0;
+		uint64_t stored = 0, length = 0, digest = 0;
+		bool valid = fread(&magic, sizeof(magic), 1, file) == 1 && fread(&version, sizeof(version), 1, file) == 1
+			&& fread(&stored, sizeof(stored), 1, file) == 1 && fread(&length, sizeof(length), 1, file) == 1
+			&& fread(&digest, sizeof(digest), 1, file) == 1 && magic == MAGIC && version == VERSION && stored == fingerprint;
+		if (valid) {
+			// La longitud se comprueba contra lo que queda del archivo antes de reservar memoria para los datos
+			long start = ftell(file);
+			valid = start >= 0 && fseek(file, 0, SEEK_END) == 0;
+			long end = valid ? ftell(file) : -1;
+			valid = valid && end >= start && length <= (uint64_t)(end - start) && fseek(file, start, SEEK_SET) == 0;
+		}
+		if (valid) {
+			data.resize((size_t)length);
+			valid = fread(data.data(), 1, data.size(), file) == data.size() && hash(data.data(), data.size()) == digest;
+		}
+		fclose(file);
+		offset = 0;
+		ok = valid;
+		return valid;
+	}
+
+	/**
+	 * @brief Lee el último estado escrito por un CheckpointWriter: el archivo o, si no es válido, el temporal, que
+	 * solo está completo si la ejecución se interrumpió entre escribirlo y renombrarlo.
+	 */
+	bool load(const std::string& filename, uint64_t fingerprint) {
+		return read(filename.c_str(), fingerprint) || read((filename + ".tmp").c_str(), fingerprint);
+	}
+
+	/**
+	 * @brief FNV-1a de 64 bits.
+	 */
+	static uint64_t hash(const char* bytes, size_t length) {
+		uint64_t h = 14695981039346656037ULL;
+		for (size_t i = 0; i < length; i++) {
+			h = (h ^ (unsigned char)bytes[i]) * 1099511628211ULL;
+		}
+		return h;
+	}
+};
+
+/**
+ * @class CheckpointWriter
+ * @brief Guarda periódicamente el estado de una ejecución en un hilo de fondo.
+ * @details El hilo que calcula llama a poll() en puntos donde su estado es coherente; cuando ha pasado el intervalo,
+ * `capture` copia el estado en un Checkpoint y este se cede al hilo de escritura, así que el cálculo no espera al disco.
+ * El archivo se escribe primero como `<archivo>.tmp` y después se renombra, por lo que una interrupción a mitad de la
+ * escritura deja intacto el estado anterior. Si llega un estado nuevo antes de escribir el anterior, solo se escribe el
+ * nuevo.
+ */
+class CheckpointWriter {
+public:
+	std::string filename;						/* Archivo del estado */
+	uint64_t fingerprint;						/* Huella de la configuración de la ejecución */
+	double interval;							/* Segundos entre estados */
+	std::function<void(Checkpoint&)> capture;	/* Copia el estado de la ejecución */
+	std::atomic<long long> written;				/* Estados escritos; lo incrementa el hilo de escritura */
+
+	bool running;						/* Indica si el hilo debe seguir */
+	bool pending;						/* Indica si `next` espera a escribirse */
+	Checkpoint next;					/* Estado pendiente de escribir */
+	std::mutex mutex;					/* Protege running, pending y next */
+	std::condition_variable wake;		/* Despierta al hilo de escritura */
+	std::thread thread;					/* Hilo de escritura */
+	std::chrono::steady_clock::time_point last;	/* Instante de la última captura */
+
+	/**
+	 * @brief Constructor de la clase CheckpointWriter.
+	 * @param file Archivo del estado
+	 * @param print Huella de la configuración de la ejecución
+	 * @param seconds Segundos entre estados
+	 */
+	CheckpointWriter(const std::string& file, uint64_t print, double seconds)
+		: filename(file), fingerprint(print), interval(seconds), written(0), running(false), pending(false) {}
+
+	~CheckpointWriter() {
+		stop();
+	}
+
+	/**
+	 * @brief Arranca el hilo de escritura. El primer estado se guarda un intervalo después.
+	 */
+	void start() {
+		last = std::chrono::steady_clock::now();
+		running = true;
+		thread = std::thread([this]() {
+			std::unique_lock<std::mutex> lock(mutex);
+			while (true) {
+				wake.wait(lock, [this]() { return pending || !running; });
+				if (!pending) {
+					break;
+				}
+				Checkpoint state;
+				std::swap(state.data, next.data);
+				pending = false;
+				lock.unlock();
+				save(state);
+				lock.lock();
+			}
+		});
+	}
+
+	/**
+	 * @brief Captura y cede el estado si ha pasado el intervalo desde la última captura.
+	 * @return true si se ha capturado
+	 */
+	bool poll() {
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (!capture || std::chrono::duration<double>(now - last).count() < interval) {
+			return false;
+		}
+		last = now;
+
+		Checkpoint state;
+		capture(state);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			std::swap(next.data, state.data);
+			pending = true;
+		}
+		wake.notify_one();
+		return true;
+	}
+
+	/**
+	 * @brief Espera a que se escriba el estado pendiente y detiene el hilo.
+	 */
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!running) {
+				return;
+			}
+			running = false;
+		}
+		wake.notify_all();
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+
+private:
+	void save(const Checkpoint& state) {
+		std::string temporary = filename + ".tmp";
+		if (!state.write(temporary.c_str(), fingerprint)) {
+			std::cout << "No se ha podido escribir el punto de control " << temporary << std::endl;
+			return;
+		}
+		// El temporal ya está en disco, así que el cambio de nombre nunca deja a la vista un archivo a medias. En Windows
+		// rename no sustituye un archivo existente: MoveFileEx lo hace sin borrar antes el anterior
+#ifdef _WIN32
+		if (!MoveFileExA(temporary.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+			std::cout << "Error al renombrar el punto de control (" << GetLastError() << ")" << std::endl;
+			return;
+		}
+#else
+		if (rename(temporary.c_str(), filename.c_str()) != 0) {
+			perror("Error al renombrar el punto de control");
+			return;
+		}
+#endif
+		written++;
+	}
+};
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,99 @@
+#ifndef CONVOLVER_H
+#define CONVOLVER_H
+
+#include <complex>
+#include <vector>
+
+#include "fft.h"
+
+/**
+ * @class Convolver
+ * @brief Convolución por bloques con una respuesta al impulso larga (solapamiento y suma con particiones uniformes).
+ * @details La respuesta se divide en particiones de blockSize muestras, cuyo espectro de 2·blockSize puntos se calcula
+ * una vez. Cada bloque de entrada se transforma una sola vez y se guarda en una línea de retardo frecuencial; la
+ * salida del bloque es la suma de los productos de cada partición con el espectro de entrada correspondiente, seguida
+ * de una transformada inversa y del solapamiento con la cola del bloque anterior. La latencia es de un bloque y la
+ * memoria no depende de la longitud de la entrada. Como las señales son reales, solo se multiplican las
+ * blockSize + 1 primeras frecuencias; el resto se obtiene por simetría conjugada.
+ */
+class Convolver {
+public:
+	int blockSize;										/* Muestras por bloque y por partición */
+	int partitions;										/* Número de particiones de la respuesta */
+	FFT fft;											/* Transformada de 2·blockSize puntos */
+	std::vector<std::complex<float>> filters;			/* Espectro de cada partición: [partición][frecuencia] */
+	std::vector<std::complex<float>> delayLine;			/* Espectros de los últimos bloques de entrada (circular) */
+	std::vector<std::complex<float>> spectrum;			/* Espacio de trabajo de 2·blockSize puntos */
+	std::vector<std::complex<float>> sum;				/* Suma de productos de blockSize + 1 frecuencias */
+	std::vector<float> overlap;							/* Cola del bloque anterior */
+	int current;										/* Posición del bloque más reciente en la línea de retardo */
+
+	/**
+	 * @brief Constructor de la clase Convolver.
+	 * @param response Respuesta al impulso
+	 * @param block Muestras por bloque (potencia de dos)
+	 */
+	Convolver(const std::vector<float>& response, int block) : fft(2 * block) {
+		blockSize = block;
+		int bins = blockSize + 1;
+		partitions = response.empty() ? 1 : (int)((response.size() + blockSize - 1) / blockSize);
+		filters.assign((size_t)partitions * bins, std::complex<float>(0, 0));
+		delayLine.assign((size_t)partitions * bins, std::complex<float>(0, 0));
+		spectrum.resize(2 * blockSize);
+		sum.resize(bins);
+		overlap.assign(blockSize, 0.0f);
+		current = 0;
+
+		for (int p = 0; p < partitions; p++) {
+			for (int i = 0; i < 2 * blockSize; i++) {
+				size_t k = (size_t)p * blockSize + i;
+				spectrum[i] = std::complex<float>(i < blockSize && k < response.size() ? response[k] : 0.0f, 0.0f);
+			}
+			fft.forward(spectrum.data());
+			std::copy(spectrum.begin(), spectrum.begin() + bins, filters.begin() + (size_t)p * bins);
+		}
+	}
+
+	/**
+	 * @brief Convoluciona un bloque de entrada.
+	 * @param in blockSize muestras de entrada
+	 * @param out blockSize muestras de salida
+	 */
+	void process(const float* in, float* out) {
+		int bins = blockSize + 1;
+
+		// Espectro del bloque de entrada, rellenado con ceros
+		for (int i = 0; i < blockSize; i++) {
+			spectrum[i] = std::complex<float>(in[i], 0.0f);
+			spectrum[blockSize + i] = std::complex<float>(0.0f, 0.0f);
+		}
+		fft.forward(spectrum.data());
+		current = (current + partitions - 1) % partitions;
+		std::copy(spectrum.begin(), spectrum.begin() + bins, delayLine.begin() + (size_t)current * bins);
+
+		// Suma de productos: la partición p se aplica al bloque de hace p bloques
+		std::fill(sum.begin(), sum.end(), std::complex<float>(0.0f, 0.0f));
+		for (int p = 0; p < partitions; p++) {
+			const std::complex<float>* x = &delayLine[(size_t)((current + p) % partitions) * bins];
+			const std::complex<float>* h = &filters[(size_t)p * bins];
+			for (int k = 0; k < bins; k++) {
+				sum[k] += FFT::multiply(x[k], h[k]);
+			}
+		}
+
+		for (int k = 0; k < bins; k++) {
+			spectrum[k] = sum[k];
+		}
+		for (int k = 1; k < blockSize; k++) {
+			spectrum[2 * blockSize - k] = std::conj(sum[k]);
+		}
+		fft.inverse(spectrum.data());
+
+		for (int i = 0; i < blockSize; i++) {
+			out[i] = spectrum[i].real() + overlap[i];
+			overlap[i] = spectrum[blockSize + i].real();
+		}
+	}
+};
+
+#endif // CONVOLVER_H
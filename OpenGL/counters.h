@@ -0,0 +1,258 @@
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#define COUNTERS_STRINGIZE_(x) #x
+#define COUNTERS_STRINGIZE(x) COUNTERS_STRINGIZE_(x)
+
+/**
+ * @brief Contadores de rendimiento.
+ */
+enum Counter { RAYS_EMITTED, REFLECTIONS, RECEPTOR_HITS, RAYS_TERMINATED, STEPS, NUM_COUNTERS };
+
+const char* const COUNTER_NAMES[NUM_COUNTERS] = { "raysEmitted", "reflections", "receptorHits", "raysTerminated", "steps" };
+
+/**
+ * @brief Valores de todos los contadores en un instante.
+ */
+struct CounterSnapshot {
+	long long values[NUM_COUNTERS];	/* Valor de cada contador */
+	double time;					/* Segundos desde el arranque de los contadores */
+};
+
+/**
+ * @class ThreadCounters
+ * @brief Contadores de un hilo.
+ * @details Solo escribe el hilo propietario, así que cada incremento es una carga y un almacenamiento relajados, sin
+ * instrucciones atómicas de lectura-modificación-escritura ni líneas de caché compartidas. Al terminar el hilo sus
+ * valores se suman al total de los hilos terminados.
+ */
+class ThreadCounters {
+public:
+	std::atomic<long long> values[NUM_COUNTERS];	/* Valor de cada contador */
+
+	ThreadCounters();
+	~ThreadCounters();
+
+	/**
+	 * @brief Suma una cantidad a un contador.
+	 */
+	void add(int counter, long long n) {
+		values[counter].store(values[counter].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	}
+};
+
+/**
+ * @class Counters
+ * @brief Registro global de los contadores de todos los hilos; la lectura suma los de cada hilo.
+ */
+class Counters {
+public:
+	std::mutex mutex;								/* Protege el registro (solo al crear y terminar hilos y al leer) */
+	std::vector<ThreadCounters*> live;				/* Contadores de los hilos vivos */
+	long long retired[NUM_COUNTERS];				/* Suma de los contadores de los hilos terminados */
+	std::chrono::steady_clock::time_point epoch;	/* Origen de los tiempos */
+
+	/**
+	 * @brief Devuelve el registro global.
+	 */
+	static Counters& instance() {
+		// No se destruye nunca, para que los hilos que terminan después de main puedan retirar sus contadores
+		static Counters* counters = new Counters();
+		return *counters;
+	}
+
+	/**
+	 * @brief Suma una cantidad a un contador del hilo actual.
+	 * @param counter Contador
+	 * @param n Cantidad
+	 */
+	static void add(int counter, long long n = 1) {
+		thread_local ThreadCounters local;
+		local.add(counter, n);
+	}
+
+	/**
+	 * @brief Devuelve la suma de los contadores de todos los hilos.
+	 */
+	static CounterSnapshot read() {
+		Counters& c = instance();
+		CounterSnapshot s;
+		std::lock_guard<std::mutex> lock(c.mutex);
+		for (int k = 0; k < NUM_COUNTERS; k++) {
+			s.values[k] = c.retired[k];
+			for (size_t t = 0; t < c.live.size(); t++) {
+				s.values[k] += c.live[t]->values[k].load(std::memory_order_relaxed);
+			}
+		}
+		s.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - c.epoch).count();
+		return s;
+	}
+
+	/**
+	 * @brief Escribe una línea de estado con los totales y el ritmo de cada contador.
+	 * @param out Destino
+	 * @param from Lectura anterior (el ritmo se calcula desde ella)
+	 * @param to Lectura actual
+	 */
+	static void print(FILE* out, const CounterSnapshot& from, const CounterSnapshot& to) {
+		double dt = to.time - from.time > 0 ? to.time - from.time : 1;
+		fprintf(out, "\r[%7.1f s]", to.time);
+		for (int k = 0; k < NUM_COUNTERS; k++) {
+			fprintf(out, " %s %.3gM (%.3gM/s)", COUNTER_NAMES[k], to.values[k] / 1e6, (to.values[k] - from.values[k]) / dt / 1e6);
+		}
+		fprintf(out, "   ");
+		fflush(out);
+	}
+
+	/**
+	 * @brief Guarda los metadatos de una ejecución: contadores, ritmos medios y datos de la máquina y la compilación.
+	 * @param filename Nombre del archivo CSV (clave,valor)
+	 * @param from Lectura al empezar la ejecución
+	 * @param to Lectura al terminar la ejecución
+	 * @param info Pares clave-valor adicionales (parámetros de la ejecución)
+	 */
+	static void exportRun(const char* filename, const CounterSnapshot& from, const CounterSnapshot& to, const std::vector<std::pair<std::string, std::string>>& info) {
+		FILE* file;
+		if (fopen_s(&file, filename, "w") != 0) {
+			perror("Error al abrir el archivo");
+			return;
+		}
+
+		double seconds = to.time - from.time;
+		fprintf(file, "key,value\n");
+		fprintf(file, "seconds,%.6f\n", seconds);
+		for (int k = 0; k < NUM_COUNTERS; k++) {
+			long long v = to.values[k] - from.values[k];
+			fprintf(file, "%s,%lld\n", COUNTER_NAMES[k], v);
+			fprintf(file, "%sPerSecond,%.3f\n", COUNTER_NAMES[k], seconds > 0 ? v / seconds : 0.0);
+		}
+		fprintf(file, "hardwareThreads,%u\n", std::thread::hardware_concurrency());
+		fprintf(file, "compiler,%s\n", compiler());
+		fprintf(file, "simd,%s\n", simd());
+		for (size_t i = 0; i < info.size(); i++) {
+			fprintf(file, "%s,%s\n", info[i].first.c_str(), info[i].second.c_str());
+		}
+
+		fclose(file);
+	}
+
+	/**
+	 * @brief Compilador con el que se construyó el programa.
+	 */
+	static const char* compiler() {
+#if defined(_MSC_VER)
+		return "msvc " COUNTERS_STRINGIZE(_MSC_VER);
+#elif defined(__clang__)
+		return "clang " __clang_version__;
+#elif defined(__GNUC__)
+		return "gcc " __VERSION__;
+#else
+		return "unknown";
+#endif
+	}
+
+	/**
+	 * @brief Conjunto de instrucciones vectoriales usado por las bandas.
+	 */
+	static const char* simd() {
+#if defined(__AVX__)
+		return "avx";
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		return "sse2";
+#else
+		return "scalar";
+#endif
+	}
+
+private:
+	Counters() : epoch(std::chrono::steady_clock::now()) {
+		for (int k = 0; k < NUM_COUNTERS; k++) {
+			retired[k] = 0;
+		}
+	}
+};
+
+inline ThreadCounters::ThreadCounters() {
+	for (int k = 0; k < NUM_COUNTERS; k++) {
+		values[k].store(0, std::memory_order_relaxed);
+	}
+	Counters& c = Counters::instance();
+	std::lock_guard<std::mutex> lock(c.mutex);
+	c.live.push_back(this);
+}
+
+inline ThreadCounters::~ThreadCounters() {
+	Counters& c = Counters::instance();
+	std::lock_guard<std::mutex> lock(c.mutex);
+	for (int k = 0; k < NUM_COUNTERS; k++) {
+		c.retired[k] += values[k].load(std::memory_order_relaxed);
+	}
+	for (size_t t = 0; t < c.live.size(); t++) {
+		if (c.live[t] == this) {
+			c.live[t] = c.live.back();
+			c.live.pop_back();
+			break;
+		}
+	}
+}
+
+/**
+ * @class StatusLine
+ * @brief Hilo que reescribe periódicamente en la consola una línea con los contadores y su ritmo.
+ */
+class StatusLine {
+public:
+	double interval;				/* Segundos entre actualizaciones */
+	bool running;					/* Indica si el hilo debe seguir */
+	std::mutex mutex;				/* Protege running */
+	std::condition_variable wake;	/* Despierta al hilo al detenerlo */
+	std::thread thread;				/* Hilo de la línea de estado */
+
+	/**
+	 * @brief Arranca la línea de estado.
+	 * @param seconds Segundos entre actualizaciones
+	 */
+	explicit StatusLine(double seconds) : interval(seconds), running(true) {
+		thread = std::thread([this]() {
+			CounterSnapshot last = Counters::read();
+			std::unique_lock<std::mutex> lock(mutex);
+			while (running) {
+				wake.wait_for(lock, std::chrono::duration<double>(interval));
+				CounterSnapshot now = Counters::read();
+				Counters::print(stdout, last, now);
+				last = now;
+			}
+			printf("\n");
+		});
+	}
+
+	~StatusLine() {
+		stop();
+	}
+
+	/**
+	 * @brief Detiene la línea de estado y termina la línea de la consola.
+	 */
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			running = false;
+		}
+		wake.notify_all();
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+};
+
+#endif // COUNTERS_H
@@ -0,0 +1,56 @@
+#ifndef CROSSOVER_H
+#define CROSSOVER_H
+
+/**
+ * @class Crossover
+ * @brief Transición entre la parte temprana (determinista) y la tardía (estadística) de una respuesta.
+ * @details Los pesos temprano y tardío suman uno en todo instante, por lo que la energía de la respuesta
+ * combinada se conserva. Con una transición inactiva ambos pesos valen uno.
+ */
+class Crossover {
+public:
+	bool active;	/* Indica si la transición está activa */
+	double time;	/* Instante central de la transición en segundos */
+	double fade;	/* Duración del fundido lineal en segundos */
+
+	Crossover() : active(false), time(0), fade(0) {}
+
+	/**
+	 * @brief Constructor de la clase Crossover.
+	 * @param t Instante central de la transición en segundos
+	 * @param f Duración del fundido lineal en segundos
+	 */
+	Crossover(double t, double f) : active(true), time(t), fade(f) {}
+
+	/**
+	 * @brief Devuelve el peso de la parte tardía en un instante.
+	 * @param t Instante en segundos
+	 */
+	double late(double t) const {
+		if (!active) {
+			return 1.0;
+		}
+		if (fade <= 0) {
+			return t < time ? 0.0 : 1.0;
+		}
+		double w = (t - (time - fade / 2)) / fade;
+		return w < 0 ? 0.0 : (w > 1 ? 1.0 : w);
+	}
+
+	/**
+	 * @brief Devuelve el peso de la parte temprana en un instante.
+	 * @param t Instante en segundos
+	 */
+	double early(double t) const {
+		return active ? 1.0 - late(t) : 1.0;
+	}
+
+	/**
+	 * @brief Devuelve el instante a partir del cual la parte temprana ya no aporta.
+	 */
+	double end() const {
+		return time + (fade > 0 ? fade / 2 : 0);
+	}
+};
+
+#endif // CROSSOVER_H
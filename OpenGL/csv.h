@@ -1,10 +1,12 @@
 #ifndef CSV_H
-#define CHV_H
+#define CSV_H
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <vector>
 
+#include "profiler.h"
+
 /**
  * @class CSV
  * @brief Clase para guardar datos en un archivo CSV
@@ -19,6 +21,7 @@ public:
 	 * @param data Datos a guardar en el archivo CSV (vector de vectores de doubles)
 	*/
 	CSV(const char* filename, const std::vector<std::vector<double>>& data) {
+		PROFILE_ZONE("CSV");
 		FILE* file;
 		if (fopen_s(&file, filename, "w") != 0) {
 			perror("Error al abrir el archivo");
@@ -39,6 +42,7 @@ public:
 	}
 
 	CSV(const char* filename, double** data, size_t numRows, size_t numCols) {
+		PROFILE_ZONE("CSV");
 		FILE* file;
 		if (fopen_s(&file, filename, "w") != 0) {
 			perror("Error al abrir el archivo");
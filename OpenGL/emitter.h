@@ -0,0 +1,190 @@
+#ifndef EMITTER_H
+#define EMITTER_H
+
+#include <vector>
+
+#include "point.h"
+#include "random.h"
+#include "bands.h"
+#include "counters.h"
+#include "checkpoint.h"
+
+/**
+ * @class RayBatchT
+ * @brief Bloque de rayos de tamaño fijo almacenado como estructura de arreglos.
+ * @details La memoria se reserva una sola vez; los rayos terminados liberan su espacio intercambiándose con el último.
+ * La geometría de los rayos se guarda con el tipo escalar Real; la distancia recorrida se acumula siempre en double.
+ */
+template <typename Real>
+class RayBatchT {
+public:
+	int count;		/* Número de rayos vivos en el bloque */
+	int capacity;	/* Capacidad máxima del bloque */
+
+	std::vector<Real> ox, oy, oz;	/* Origen de cada rayo */
+	std::vector<Real> dx, dy, dz;	/* Dirección unitaria de cada rayo */
+	std::vector<double> distance;	/* Distancia recorrida por cada rayo */
+	std::vector<Bands> energy;		/* Energía de cada rayo por banda */
+	std::vector<unsigned char> diffuse;	/* Indica si el rayo ya tuvo alguna reflexión difusa */
+	std::vector<int> wall;			/* Plano que alcanzará cada rayo (-1 si ninguno), calculado por pasadas */
+	std::vector<Real> hitTime;		/* Distancia hasta ese plano */
+
+	RayBatchT() : count(0), capacity(0) {}
+
+	/**
+	 * @brief Reserva memoria para un número máximo de rayos.
+	 * @param n Capacidad del bloque
+	 */
+	void reserve(int n) {
+		capacity = n;
+		ox.resize(n); oy.resize(n); oz.resize(n);
+		dx.resize(n); dy.resize(n); dz.resize(n);
+		distance.resize(n);
+		energy.resize(n);
+		diffuse.resize(n);
+		wall.resize(n);
+		hitTime.resize(n);
+	}
+
+	/**
+	 * @brief Elimina un rayo del bloque moviendo el último rayo a su posición.
+	 * @param i Índice del rayo a eliminar
+	 */
+	void remove(int i) {
+		int last = --count;
+		ox[i] = ox[last]; oy[i] = oy[last]; oz[i] = oz[last];
+		dx[i] = dx[last]; dy[i] = dy[last]; dz[i] = dz[last];
+		distance[i] = distance[last];
+		energy[i] = energy[last];
+		diffuse[i] = diffuse[last];
+		wall[i] = wall[last];
+		hitTime[i] = hitTime[last];
+	}
+
+	/**
+	 * @brief Guarda los rayos vivos. `wall` y `hitTime` no se guardan porque se recalculan en cada pasada.
+	 */
+	void save(Checkpoint& c) const {
+		c.put(count);
+		c.putVector(ox, count); c.putVector(oy, count); c.putVector(oz, count);
+		c.putVector(dx, count); c.putVector(dy, count); c.putVector(dz, count);
+		c.putVector(distance, count);
+		c.putVector(energy, count);
+		c.putVector(diffuse, count);
+	}
+
+	/**
+	 * @brief Restaura los rayos guardados con save. El bloque debe tener capacidad para todos.
+	 * @return false si los datos no son válidos
+	 */
+	bool load(Checkpoint& c) {
+		int n = 0;
+		if (!c.get(n) || n < 0 || n > capacity) {
+			c.ok = false;
+			return false;
+		}
+		c.getVector(ox); c.getVector(oy); c.getVector(oz);
+		c.getVector(dx); c.getVector(dy); c.getVector(dz);
+		c.getVector(distance);
+		c.getVector(energy);
+		c.getVector(diffuse);
+		count = c.ok ? n : 0;
+		return c.ok;
+	}
+};
+
+typedef RayBatchT<double> RayBatch;	/* Bloque de rayos en doble precisión */
+
+/**
+ * @class Emitter
+ * @brief Fuente puntual omnidireccional que genera rayos con direcciones aleatorias uniformes.
+ * @details Los rayos se generan por bloques; cada bloque usa su propio flujo del generador, indexado por el número de
+ * bloque, por lo que el resultado depende de la semilla y también del tamaño de bloque (`--chunk`): con otro tamaño
+ * los rayos se reparten en otros flujos.
+ */
+class Emitter {
+public:
+	Point position;			/* Posición de la fuente */
+	long long totalRays;	/* Número total de rayos a emitir */
+	long long emitted;		/* Número de rayos emitidos hasta el momento */
+	long long chunkIndex;	/* Índice del siguiente bloque */
+	uint64_t seed;			/* Semilla del generador */
+	float energy;			/* Energía total de la fuente */
+	float loss;				/* Pérdida de energía por reflexión */
+
+	/**
+	 * @brief Constructor de la clase Emitter.
+	 * @param p Posición de la fuente
+	 * @param n Número total de rayos
+	 * @param e Energía total de la fuente
+	 * @param l Pérdida de energía por reflexión
+	 * @param s Semilla del generador
+	 */
+	Emitter(Point p, long long n, float e, float l, uint64_t s) {
+		position = p;
+		totalRays = n;
+		energy = e;
+		loss = l;
+		seed = s;
+		emitted = 0;
+		chunkIndex = 0;
+	}
+
+	/**
+	 * @brief Guarda el avance de la emisión; el generador de cada bloque se deriva de la semilla y de chunkIndex.
+	 */
+	void save(Checkpoint& c) const {
+		c.put(emitted);
+		c.put(chunkIndex);
+	}
+
+	/**
+	 * @brief Restaura el avance guardado con save.
+	 */
+	bool load(Checkpoint& c) {
+		return c.get(emitted) && c.get(chunkIndex);
+	}
+
+	/**
+	 * @brief Indica si ya se emitieron todos los rayos.
+	 */
+	bool done() const {
+		return emitted >= totalRays;
+	}
+
+	/**
+	 * @brief Llena un bloque con el siguiente grupo de rayos. Las direcciones se generan en double y se redondean al
+	 * tipo del bloque, así que las dos precisiones parten de los mismos rayos.
+	 * @param batch Bloque a llenar (se sobrescribe)
+	 * @return Número de rayos emitidos en el bloque
+	 */
+	template <typename Real>
+	int emit(RayBatchT<Real>& batch) {
+		long long remaining = totalRays - emitted;
+		int n = remaining < batch.capacity ? (int)remaining : batch.capacity;
+		Bands rayEnergy = Bands((float)((double)energy / totalRays));
+
+		Random rng = Random::forStream(seed, chunkIndex);
+		for (int i = 0; i < n; i++) {
+			double x, y, z;
+			rng.nextDirection(x, y, z);
+			batch.ox[i] = (Real)position.x;
+			batch.oy[i] = (Real)position.y;
+			batch.oz[i] = (Real)position.z;
+			batch.dx[i] = (Real)x;
+			batch.dy[i] = (Real)y;
+			batch.dz[i] = (Real)z;
+			batch.distance[i] = 0;
+			batch.energy[i] = rayEnergy;
+			batch.diffuse[i] = 0;
+		}
+
+		batch.count = n;
+		emitted += n;
+		Counters::add(RAYS_EMITTED, n);
+		chunkIndex++;
+		return n;
+	}
+};
+
+#endif // EMITTER_H
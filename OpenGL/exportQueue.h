@@ -0,0 +1,143 @@
+#ifndef EXPORT_QUEUE_H
+#define EXPORT_QUEUE_H
+
+#include <cstdlib>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "csv.h"
+#include "profiler.h"
+
+/**
+ * @class ExportQueue
+ * @brief Cola de escritura de matrices a CSV en un hilo de fondo.
+ * @details Quien encola una matriz no espera al disco. Hay dos formas de entregarla:
+ * - `take`: la cola pasa a ser dueña de las filas y las libera (delete[]) después de escribirlas; no se copian.
+ * - `lend`: la matriz sigue siendo de quien la encola, que debe mantenerla viva y sin modificar hasta que se escriba.
+ *
+ * La memoria de las matrices cedidas que esperan en la cola está acotada por `maxBytes`: si se supera, `take`
+ * espera a que se escriban las anteriores (una matriz más grande que el límite entra sola). Al terminar el programa
+ * se espera a que se escriba todo.
+ */
+class ExportQueue {
+public:
+	/**
+	 * @brief Matriz pendiente de escribir.
+	 */
+	struct Job {
+		std::string filename;	/* Archivo CSV */
+		double** data;			/* Filas de la matriz */
+		size_t rows;			/* Número de filas */
+		size_t cols;			/* Número de columnas */
+		bool owned;				/* Indica si la cola libera las filas al terminar */
+	};
+
+	size_t maxBytes;				/* Bytes de matrices cedidas que pueden esperar en la cola */
+	size_t pendingBytes;			/* Bytes de matrices cedidas en la cola o escribiéndose */
+	int busy;						/* Trabajos en la cola o escribiéndose */
+	std::deque<Job> jobs;			/* Trabajos pendientes */
+	std::mutex mutex;				/* Protege la cola y los contadores */
+	std::condition_variable work;	/* Avisa al hilo de que hay trabajo */
+	std::condition_variable done;	/* Avisa de que ha terminado un trabajo */
+	std::thread thread;				/* Hilo de escritura */
+
+	/**
+	 * @brief Devuelve la cola global.
+	 */
+	static ExportQueue& instance() {
+		// No se destruye nunca: el hilo sigue vivo hasta el final y la espera se hace en atexit
+		static ExportQueue* queue = new ExportQueue();
+		return *queue;
+	}
+
+	/**
+	 * @brief Encola una matriz y cede sus filas a la cola, que las libera después de escribirlas.
+	 * @param filename Archivo CSV
+	 * @param data Filas de la matriz (cada una reservada con new[], el array de filas también)
+	 * @param rows Número de filas
+	 * @param cols Número de columnas
+	 */
+	void take(const std::string& filename, double** data, size_t rows, size_t cols) {
+		size_t bytes = rows * cols * sizeof(double);
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [&]() { return pendingBytes == 0 || pendingBytes + bytes <= maxBytes; });
+		pendingBytes += bytes;
+		push(lock, filename, data, rows, cols, true);
+	}
+
+	/**
+	 * @brief Encola una matriz que sigue siendo de quien la encola.
+	 * @details Ni el array de filas ni las filas pueden cambiar hasta que wait() termine. En particular,
+	 * Room::energyTrans presta energyRoom y energyReceptors y no se debe volver a llamar sobre la misma habitación
+	 * hasta entonces, porque sustituiría las filas que se están escribiendo.
+	 * @param filename Archivo CSV
+	 * @param data Filas de la matriz; deben seguir vivas y sin cambios hasta que se escriban
+	 * @param rows Número de filas
+	 * @param cols Número de columnas
+	 */
+	void lend(const std::string& filename, double** data, size_t rows, size_t cols) {
+		std::unique_lock<std::mutex> lock(mutex);
+		push(lock, filename, data, rows, cols, false);
+	}
+
+	/**
+	 * @brief Espera a que se hayan escrito todas las matrices encoladas.
+	 */
+	void wait() {
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [this]() { return busy == 0; });
+	}
+
+private:
+	ExportQueue() : maxBytes((size_t)512 << 20), pendingBytes(0), busy(0) {
+		thread = std::thread([this]() { loop(); });
+		thread.detach();
+		std::atexit([]() { instance().wait(); });
+	}
+
+	void push(std::unique_lock<std::mutex>& lock, const std::string& filename, double** data, size_t rows, size_t cols, bool owned) {
+		Job job;
+		job.filename = filename;
+		job.data = data;
+		job.rows = rows;
+		job.cols = cols;
+		job.owned = owned;
+		jobs.push_back(job);
+		busy++;
+		lock.unlock();
+		work.notify_one();
+	}
+
+	void loop() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			work.wait(lock, [this]() { return !jobs.empty(); });
+			Job job = jobs.front();
+			jobs.pop_front();
+			lock.unlock();
+
+			{
+				PROFILE_ZONE("ExportQueue write");
+				CSV(job.filename.c_str(), job.data, job.rows, job.cols);
+			}
+			if (job.owned) {
+				for (size_t i = 0; i < job.rows; i++) {
+					delete[] job.data[i];
+				}
+				delete[] job.data;
+			}
+
+			lock.lock();
+			if (job.owned) {
+				pendingBytes -= job.rows * job.cols * sizeof(double);
+			}
+			busy--;
+			done.notify_all();
+		}
+	}
+};
+
+#endif // EXPORT_QUEUE_H
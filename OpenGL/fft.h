@@ -0,0 +1,102 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <cmath>
+#include <complex>
+#include <vector>
+
+/**
+ * @class FFT
+ * @brief Transformada rápida de Fourier compleja de tamaño potencia de dos (radix 2, iterativa, in situ).
+ * @details Los factores de giro y la permutación de inversión de bits se calculan una vez en el constructor, así que
+ * un mismo objeto se puede reutilizar para muchas transformadas del mismo tamaño, también desde varios hilos.
+ */
+class FFT {
+public:
+	int size;										/* Número de puntos */
+	std::vector<std::complex<float>> twiddles;		/* exp(-2 pi i k / size) para k < size/2 */
+	std::vector<int> reversed;						/* Índice con los bits invertidos */
+
+	/**
+	 * @brief Constructor de la clase FFT.
+	 * @param n Número de puntos (potencia de dos)
+	 */
+	explicit FFT(int n) {
+		size = n;
+		int bits = 0;
+		while ((1 << bits) < n) bits++;
+
+		reversed.resize(n);
+		for (int i = 0; i < n; i++) {
+			int r = 0;
+			for (int b = 0; b < bits; b++) {
+				r |= ((i >> b) & 1) << (bits - 1 - b);
+			}
+			reversed[i] = r;
+		}
+
+		twiddles.resize(n / 2);
+		for (int k = 0; k < n / 2; k++) {
+			double a = -2.0 * 3.14159265358979323846 * k / n;
+			twiddles[k] = std::complex<float>((float)cos(a), (float)sin(a));
+		}
+	}
+
+	/**
+	 * @brief Devuelve la menor potencia de dos mayor o igual que n.
+	 */
+	static int nextPowerOfTwo(long long n) {
+		int p = 1;
+		while (p < n) p <<= 1;
+		return p;
+	}
+
+	/**
+	 * @brief Producto complejo sin la comprobación de infinitos y NaN del operador estándar.
+	 */
+	static std::complex<float> multiply(const std::complex<float>& a, const std::complex<float>& b) {
+		return std::complex<float>(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+	}
+
+	/**
+	 * @brief Transformada directa in situ.
+	 * @param x Datos (size puntos)
+	 */
+	void forward(std::complex<float>* x) const {
+		transform(x, false);
+	}
+
+	/**
+	 * @brief Transformada inversa in situ, normalizada por 1/size.
+	 * @param x Datos (size puntos)
+	 */
+	void inverse(std::complex<float>* x) const {
+		transform(x, true);
+		float scale = 1.0f / size;
+		for (int i = 0; i < size; i++) {
+			x[i] *= scale;
+		}
+	}
+
+private:
+	void transform(std::complex<float>* x, bool inv) const {
+		for (int i = 0; i < size; i++) {
+			if (i < reversed[i]) std::swap(x[i], x[reversed[i]]);
+		}
+
+		for (int len = 2; len <= size; len <<= 1) {
+			int half = len / 2, step = size / len;
+			for (int i = 0; i < size; i += len) {
+				for (int k = 0; k < half; k++) {
+					std::complex<float> w = inv ? std::conj(twiddles[k * step]) : twiddles[k * step];
+					std::complex<float> u = x[i + k];
+					std::complex<float> v = multiply(x[i + k + half], w);
+					x[i + k] = u + v;
+					x[i + k + half] = u - v;
+				}
+			}
+		}
+	}
+};
+
+#endif // FFT_H
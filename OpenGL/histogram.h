@@ -0,0 +1,111 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdio.h>
+#include <vector>
+
+#include "bands.h"
+#include "csv.h"
+
+/**
+ * @class Histogram
+ * @brief Histograma energía-tiempo de un receptor por banda de octava.
+ * @details La energía se guarda intercalada: las NUM_BANDS bandas de un intervalo son contiguas.
+ */
+class Histogram {
+public:
+	double binWidth;			/* Ancho de cada intervalo en segundos */
+	int numBins;				/* Número de intervalos */
+	std::vector<double> energy;	/* Energía acumulada en cada intervalo y banda */
+
+	Histogram() : binWidth(0), numBins(0) {}
+
+	/**
+	 * @brief Constructor de la clase Histogram.
+	 * @param bw Ancho de cada intervalo en segundos
+	 * @param maxTime Duración máxima de la respuesta en segundos
+	 */
+	Histogram(double bw, double maxTime) {
+		binWidth = bw;
+		numBins = (int)(maxTime / bw + 0.5);
+		energy.assign((size_t)numBins * NUM_BANDS, 0.0);
+	}
+
+	/**
+	 * @brief Acumula energía en el intervalo correspondiente a un instante.
+	 * @param t Instante de llegada en segundos
+	 * @param e Energía que llega en cada banda
+	 */
+	void add(double t, const Bands& e) {
+		int bin = (int)(t / binWidth);
+		if (bin >= 0 && bin < numBins) {
+			double* dst = &energy[(size_t)bin * NUM_BANDS];
+			for (int b = 0; b < NUM_BANDS; b++) {
+				dst[b] += e[b];
+			}
+		}
+	}
+
+	/**
+	 * @brief Suma la energía de otro histograma con los mismos intervalos.
+	 * @param h Histograma a sumar
+	 * @param gain Ganancia de energía aplicada al histograma sumado
+	 */
+	void accumulate(const Histogram& h, double gain = 1.0) {
+		for (size_t i = 0; i < energy.size(); i++) {
+			energy[i] += gain * h.energy[i];
+		}
+	}
+
+	/**
+	 * @brief Devuelve la energía acumulada en un intervalo y una banda.
+	 * @param bin Índice del intervalo
+	 * @param band Índice de la banda
+	 */
+	double at(int bin, int band) const {
+		return energy[(size_t)bin * NUM_BANDS + band];
+	}
+
+	/**
+	 * @brief Devuelve la curva energía-tiempo de una banda.
+	 * @param band Índice de la banda
+	 */
+	std::vector<double> band(int band) const {
+		std::vector<double> curve(numBins);
+		for (int i = 0; i < numBins; i++) {
+			curve[i] = at(i, band);
+		}
+		return curve;
+	}
+
+	/**
+	 * @brief Devuelve la energía total acumulada en una banda.
+	 * @param band Índice de la banda
+	 */
+	double total(int band) const {
+		double sum = 0;
+		for (int i = 0; i < numBins; i++) {
+			sum += at(i, band);
+		}
+		return sum;
+	}
+
+	/**
+	 * @brief Exporta un conjunto de histogramas a un archivo CSV por banda, una fila por histograma.
+	 * @param prefix Prefijo de los archivos; se les añade la frecuencia central de la banda
+	 * @param histograms Histogramas a exportar
+	 */
+	static void exportCSV(const char* prefix, const std::vector<Histogram>& histograms) {
+		for (int b = 0; b < NUM_BANDS; b++) {
+			std::vector<std::vector<double>> data;
+			for (size_t i = 0; i < histograms.size(); i++) {
+				data.push_back(histograms[i].band(b));
+			}
+			char filename[256];
+			snprintf(filename, sizeof(filename), "%s_%d.csv", prefix, (int)BAND_FREQUENCIES[b]);
+			CSV(filename, data);
+		}
+	}
+};
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,253 @@
+#ifndef HIT_LOG_H
+#define HIT_LOG_H
+
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Llegada de una partícula a un receptor.
+ */
+struct HitRecord {
+	float time;			/* Segundos simulados */
+	float energy;		/* Energía registrada por el receptor */
+	int triangle;		/* Último triángulo de la habitación en que se reflejó la partícula (índice global) */
+	float dx, dy, dz;	/* Dirección de la partícula */
+};
+
+/**
+ * @class HitRing
+ * @brief Cola circular de tamaño fijo de llegadas de un receptor, con un productor y un consumidor.
+ * @details Escribe el hilo de la simulación y lee el hilo de escritura, sin bloqueos: cada lado solo avanza su propio
+ * índice y lee el del otro con orden acquire. Cuando la cola llega a la mitad se despierta al consumidor para que la
+ * vacíe antes de su siguiente vaciado periódico. Si aun así se llena, la llegada se descarta y se cuenta, para que la
+ * simulación no espere nunca al disco.
+ */
+class HitRing {
+public:
+	std::vector<HitRecord> records;		/* Llegadas */
+	unsigned mask;						/* Capacidad menos uno (la capacidad es potencia de dos) */
+	std::atomic<unsigned> head;			/* Llegadas escritas (solo lo modifica el productor) */
+	std::atomic<unsigned> tail;			/* Llegadas leídas (solo lo modifica el consumidor) */
+	std::atomic<long long> dropped;		/* Llegadas descartadas por tener la cola llena */
+	std::condition_variable* wake;		/* Aviso al consumidor cuando la cola llega a la mitad (puede ser nullptr) */
+
+	/**
+	 * @brief Constructor de la clase HitRing.
+	 * @param capacity Llegadas que caben en la cola; se redondea a la siguiente potencia de dos
+	 */
+	explicit HitRing(unsigned capacity = 1024) : head(0), tail(0), dropped(0), wake(nullptr) {
+		unsigned size = 2;
+		while (size < capacity) {
+			size *= 2;
+		}
+		records.resize(size);
+		mask = size - 1;
+	}
+
+	/**
+	 * @brief Añade una llegada.
+	 * @return false si la cola estaba llena y la llegada se ha descartado
+	 */
+	bool push(const HitRecord& r) {
+		unsigned h = head.load(std::memory_order_relaxed);
+		unsigned size = h - tail.load(std::memory_order_acquire);
+		if (size == mask + 1) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		records[h & mask] = r;
+		head.store(h + 1, std::memory_order_release);
+		if (wake && size + 1 == (mask + 1) / 2) {
+			wake->notify_one();
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Saca todas las llegadas disponibles.
+	 * @param out Vector al que se añaden
+	 * @return Número de llegadas sacadas
+	 */
+	size_t drain(std::vector<HitRecord>& out) {
+		unsigned t = tail.load(std::memory_order_relaxed);
+		unsigned h = head.load(std::memory_order_acquire);
+		for (unsigned i = t; i != h; i++) {
+			out.push_back(records[i & mask]);
+		}
+		tail.store(h, std::memory_order_release);
+		return h - t;
+	}
+};
+
+/**
+ * @class HitWriter
+ * @brief Hilo que vacía periódicamente las colas de llegadas de los receptores en sus archivos CSV.
+ * @details Cada archivo tiene la cabecera `time,energy,triangle,dx,dy,dz` y crece mientras dure la simulación. El
+ * texto de cada archivo se acumula en memoria y se añade al archivo al superar FLUSH bytes o al detener el hilo, así
+ * que no hace falta tener abiertos a la vez los archivos de todos los receptores. Las colas son del HitWriter, que las
+ * crea en add() y las libera al destruirse.
+ */
+class HitWriter {
+public:
+	static const size_t FLUSH = 16384;				/* Bytes de texto por archivo antes de escribirlo */
+	static const unsigned MAX_CAPACITY = 1 << 14;	/* Límite de la capacidad de cada cola */
+
+	/**
+	 * @brief Destino de una cola.
+	 */
+	struct Sink {
+		HitRing* ring;			/* Cola del receptor */
+		std::string filename;	/* Archivo CSV */
+		std::string pending;	/* Texto pendiente de escribir */
+		bool created;			/* Indica si el archivo ya se ha creado (con su cabecera) */
+		long long written;		/* Llegadas escritas */
+	};
+
+	std::vector<Sink> sinks;		/* Destinos de las colas */
+	double interval;				/* Segundos entre vaciados */
+	bool running;					/* Indica si el hilo debe seguir */
+	std::mutex mutex;				/* Protege running */
+	std::condition_variable wake;	/* Despierta al hilo al detenerlo o cuando una cola llega a la mitad */
+	std::thread thread;				/* Hilo de escritura */
+
+	explicit HitWriter(double seconds = 0.05) : interval(seconds), running(false) {}
+
+	~HitWriter() {
+		stop();
+		for (size_t i = 0; i < sinks.size(); i++) {
+			delete sinks[i].ring;
+		}
+	}
+
+	/**
+	 * @brief Capacidad de cola suficiente para las llegadas de un receptor entre dos vaciados.
+	 * @details Una partícula llega como mucho una vez por paso a un receptor, así que entre dos vaciados hay como mucho
+	 * particles * rate * interval llegadas. Se limita a MAX_CAPACITY; si la simulación va más rápida que el tiempo
+	 * real, el aviso a mitad de cola adelanta el vaciado.
+	 * @param particles Partículas de la simulación
+	 * @param rate Pasos por segundo simulado
+	 */
+	unsigned capacityFor(int particles, double rate) const {
+		double arrivals = particles * ceil(rate * interval);
+		return arrivals < MAX_CAPACITY ? (unsigned)arrivals : MAX_CAPACITY;
+	}
+
+	/**
+	 * @brief Crea una cola y la registra con su archivo. Debe llamarse antes de start().
+	 * @param filename Archivo CSV
+	 * @param capacity Llegadas que caben en la cola
+	 * @return Cola, que sigue siendo del HitWriter
+	 */
+	HitRing* add(const std::string& filename, unsigned capacity) {
+		Sink s;
+		s.ring = new HitRing(capacity);
+		s.ring->wake = &wake;
+		s.filename = filename;
+		s.created = false;
+		s.written = 0;
+		sinks.push_back(s);
+		return s.ring;
+	}
+
+	/**
+	 * @brief Llegadas descartadas en todas las colas por estar llenas.
+	 */
+	long long dropped() const {
+		long long total = 0;
+		for (size_t i = 0; i < sinks.size(); i++) {
+			total += sinks[i].ring->dropped.load(std::memory_order_relaxed);
+		}
+		return total;
+	}
+
+	/**
+	 * @brief Arranca el hilo de escritura.
+	 */
+	void start() {
+		running = true;
+		thread = std::thread([this]() {
+			std::vector<HitRecord> batch;
+			std::unique_lock<std::mutex> lock(mutex);
+			while (running) {
+				wake.wait_for(lock, std::chrono::duration<double>(interval));
+				lock.unlock();
+				drain(batch, false);
+				lock.lock();
+			}
+			lock.unlock();
+			drain(batch, true);
+		});
+	}
+
+	/**
+	 * @brief Detiene el hilo después de escribir todas las llegadas pendientes.
+	 */
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!running) {
+				return;
+			}
+			running = false;
+		}
+		wake.notify_all();
+		if (thread.joinable()) {
+			thread.join();
+		}
+
+		for (size_t i = 0; i < sinks.size(); i++) {
+			long long dropped = sinks[i].ring->dropped.load();
+			if (dropped > 0) {
+				std::cout << sinks[i].filename << ": " << dropped << " llegadas descartadas (cola llena)" << std::endl;
+			}
+		}
+	}
+
+private:
+	/**
+	 * @brief Vacía todas las colas; con `all` escribe también el texto pendiente de cada archivo.
+	 */
+	void drain(std::vector<HitRecord>& batch, bool all) {
+		char line[128];
+		for (size_t i = 0; i < sinks.size(); i++) {
+			Sink& s = sinks[i];
+			batch.clear();
+			s.ring->drain(batch);
+			for (size_t k = 0; k < batch.size(); k++) {
+				const HitRecord& r = batch[k];
+				int n = snprintf(line, sizeof(line), "%.6f,%.6f,%d,%.6f,%.6f,%.6f\n", r.time, r.energy, r.triangle, r.dx, r.dy, r.dz);
+				s.pending.append(line, n);
+			}
+			s.written += batch.size();
+			if (s.pending.size() >= FLUSH || (all && (!s.pending.empty() || !s.created))) {
+				flush(s);
+			}
+		}
+	}
+
+	void flush(Sink& s) {
+		FILE* file;
+		if (fopen_s(&file, s.filename.c_str(), s.created ? "a" : "w") != 0) {
+			perror("Error al abrir el archivo");
+			s.pending.clear();
+			return;
+		}
+		if (!s.created) {
+			fprintf(file, "time,energy,triangle,dx,dy,dz\n");
+			s.created = true;
+		}
+		fwrite(s.pending.data(), 1, s.pending.size(), file);
+		fclose(file);
+		s.pending.clear();
+	}
+};
+
+#endif // HIT_LOG_H
@@ -0,0 +1,135 @@
+#ifndef HYBRID_H
+#define HYBRID_H
+
+#include <cmath>
+#include <vector>
+
+#include "room.h"
+#include "emitter.h"
+#include "histogram.h"
+#include "crossover.h"
+#include "tracer.h"
+#include "imageSource.h"
+
+/**
+ * @class Hybrid
+ * @brief Respuesta híbrida: fuentes imagen antes de la transición y trazado de rayos después.
+ * @details La parte especular temprana se calcula con el método de fuentes imagen, limitado al instante en que termina
+ * la transición. El trazado de rayos aporta la parte tardía y, en todo instante, los caminos con alguna reflexión
+ * difusa, que las fuentes imagen no modelan. Los pesos temprano y tardío suman uno, por lo que la energía se conserva.
+ * Si la habitación no es una caja, toda la respuesta se calcula con trazado de rayos.
+ */
+class Hybrid {
+public:
+	Room* room;							/* Habitación */
+	std::vector<Point> receptors;		/* Centros de los receptores */
+	double radio;						/* Radio de los receptores */
+	Crossover crossover;				/* Transición entre la parte temprana y la tardía */
+	Tracer tracer;						/* Trazador de la parte tardía (planos y materiales precalculados) */
+	ImageSource imageSource;			/* Fuentes imagen de la parte temprana (límites de la caja precalculados) */
+	std::vector<Histogram> histograms;	/* Respuesta combinada de cada receptor para la última fuente */
+	long long images;					/* Imágenes usadas en la parte temprana */
+	long long rays;						/* Rayos trazados en la parte tardía */
+
+	/**
+	 * @brief Constructor de la clase Hybrid. Todo lo que depende solo de la habitación se calcula aquí una vez y se
+	 * reutiliza en cada fuente.
+	 * @param rm Habitación
+	 * @param rs Centros de los receptores
+	 * @param r Radio de los receptores
+	 * @param binWidth Ancho de los intervalos de los histogramas en segundos
+	 * @param maxTime Duración máxima de la respuesta en segundos
+	 * @param c Transición entre la parte temprana y la tardía (inactiva: solo trazado de rayos)
+	 * @param chunkSize Número de rayos por bloque
+	 * @param threshold Umbral relativo de energía de la ruleta rusa y de la poda de imágenes
+	 */
+	Hybrid(Room& rm, const std::vector<Point>& rs, double r, double binWidth, double maxTime, const Crossover& c, int chunkSize, double threshold)
+		: tracer(rm, rs, r, binWidth, maxTime, chunkSize, threshold), imageSource(rm, 0, c.end(), threshold) {
+		room = &rm;
+		receptors = rs;
+		radio = r;
+		crossover = c;
+		images = 0;
+		rays = 0;
+
+		if (crossover.active && imageSource.valid) {
+			// Una imagen de índices (i, j, k) está al menos a (|i| - 1), (|j| - 1) y (|k| - 1) lados de cualquier
+			// receptor en cada eje, así que su distancia es al menos (orden - 3) * lado mínimo / sqrt(3). Con este orden
+			// ningún camino especular anterior al final de la transición queda fuera
+			double side = imageSource.high[0] - imageSource.low[0];
+			for (int a = 1; a < 3; a++) {
+				side = fmin(side, imageSource.high[a] - imageSource.low[a]);
+			}
+			imageSource.maxOrder = (int)ceil(sqrt(3.0) * crossover.end() * V_SON / side) + 3;
+			imageSource.crossover = crossover;
+			tracer.crossover = crossover;
+		}
+	}
+
+	/**
+	 * @brief Calcula la respuesta de una fuente. El resultado queda en `histograms`.
+	 * @param emitter Emisor de rayos de la fuente
+	 */
+	void run(Emitter& emitter) {
+		begin(emitter);
+		finish(emitter);
+	}
+
+	/**
+	 * @brief Primera parte de run: vacía el trazador y calcula la parte temprana.
+	 * @param emitter Emisor de rayos de la fuente
+	 */
+	void begin(Emitter& emitter) {
+		tracer.reset();
+		histograms = tracer.histograms;
+
+		if (crossover.active && imageSource.valid) {
+			imageSource.run(emitter.position, emitter.energy, emitter.loss, receptors, radio, histograms);
+			images += imageSource.images;
+		}
+	}
+
+	/**
+	 * @brief Segunda parte de run: traza los rayos y suma la parte tardía. Tras restaurar un punto de control se llama
+	 * sin begin para continuar la fuente en curso.
+	 * @param emitter Emisor de rayos de la fuente
+	 */
+	void finish(Emitter& emitter) {
+		tracer.run(emitter);
+		rays += tracer.raysTraced;
+		for (size_t i = 0; i < histograms.size(); i++) {
+			histograms[i].accumulate(tracer.histograms[i]);
+		}
+	}
+
+	/**
+	 * @brief Guarda el estado de la fuente en curso: contadores, parte temprana y trazador.
+	 */
+	void save(Checkpoint& c) const {
+		c.put(images);
+		c.put(rays);
+		for (size_t i = 0; i < histograms.size(); i++) {
+			c.putVector(histograms[i].energy);
+		}
+		tracer.save(c);
+	}
+
+	/**
+	 * @brief Restaura el estado guardado con save.
+	 * @return false si los datos no son válidos
+	 */
+	bool load(Checkpoint& c) {
+		c.get(images);
+		c.get(rays);
+		histograms = tracer.histograms;
+		for (size_t i = 0; i < histograms.size(); i++) {
+			size_t size = histograms[i].energy.size();
+			if (c.getVector(histograms[i].energy) != size) {
+				c.ok = false;
+			}
+		}
+		return tracer.load(c);
+	}
+};
+
+#endif // HYBRID_H
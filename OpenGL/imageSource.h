@@ -0,0 +1,190 @@
+#ifndef IMAGE_SOURCE_H
+#define IMAGE_SOURCE_H
+
+#include <cmath>
+#include <vector>
+
+#include "point.h"
+#include "room.h"
+#include "bands.h"
+#include "histogram.h"
+#include "crossover.h"
+#include "profiler.h"
+
+/**
+ * @class ImageSource
+ * @brief Método de fuentes imagen para habitaciones en forma de caja (genCube).
+ * @details En una caja de lados paralelos a los ejes, las imágenes de la fuente forman una malla regular indexada
+ * por (nx, ny, nz); el orden de reflexión es |nx| + |ny| + |nz|. Cada imagen aporta una llegada determinista a
+ * cada receptor con energía E · r² / (4 d²) multiplicada por el factor de reflexión especular de cada pared
+ * atravesada, que es el valor esperado que acumularía el trazado de rayos para el mismo camino.
+ *
+ * Las imágenes se descartan si su energía cae por debajo del umbral o si llegan después de la duración máxima.
+ * Con una transición activa, cada llegada se pondera con el peso temprano.
+ */
+class ImageSource {
+public:
+	Room* room;				/* Habitación */
+	bool valid;				/* Indica si la habitación es una caja de lados paralelos a los ejes */
+	double low[3];			/* Coordenadas de las paredes inferiores (x, y, z) */
+	double high[3];			/* Coordenadas de las paredes superiores (x, y, z) */
+	int lowPlane[3];		/* Índice del plano de cada pared inferior */
+	int highPlane[3];		/* Índice del plano de cada pared superior */
+	int maxOrder;			/* Orden máximo de reflexión */
+	double maxTime;			/* Duración máxima de la respuesta en segundos */
+	double threshold;		/* Umbral de energía relativo a la energía de la fuente */
+	Crossover crossover;	/* Transición con la parte tardía estadística (inactiva por defecto) */
+	long long images;		/* Imágenes que llegaron a algún receptor en la última ejecución */
+	long long arrivals;		/* Llegadas escritas en los histogramas en la última ejecución */
+
+	/**
+	 * @brief Constructor de la clase ImageSource.
+	 * @param rm Habitación
+	 * @param order Orden máximo de reflexión
+	 * @param maxT Duración máxima de la respuesta en segundos
+	 * @param th Umbral de energía relativo a la energía de la fuente
+	 */
+	ImageSource(Room& rm, int order, double maxT, double th) {
+		room = &rm;
+		maxOrder = order;
+		maxTime = maxT;
+		threshold = th;
+		images = 0;
+		arrivals = 0;
+		valid = findBox();
+	}
+
+	/**
+	 * @brief Obtiene los límites de la caja a partir de las normales de los planos de la habitación.
+	 * @return `true` si la habitación es una caja de lados paralelos a los ejes, `false` en caso contrario
+	 */
+	bool findBox() {
+		for (int a = 0; a < 3; a++) {
+			lowPlane[a] = -1;
+			highPlane[a] = -1;
+		}
+
+		for (int i = 0; i < room->numPlanes; i++) {
+			Vec3 n = room->planes[i].getNormal();
+			double c[3] = { n.x, n.y, n.z };
+			double p[3] = { room->planes[i].points[0].x, room->planes[i].points[0].y, room->planes[i].points[0].z };
+			for (int a = 0; a < 3; a++) {
+				// La normal apunta hacia el interior: +eje en la pared inferior, -eje en la superior
+				if (c[a] > 0.999) {
+					low[a] = p[a];
+					lowPlane[a] = i;
+				}
+				else if (c[a] < -0.999) {
+					high[a] = p[a];
+					highPlane[a] = i;
+				}
+			}
+		}
+
+		for (int a = 0; a < 3; a++) {
+			if (lowPlane[a] == -1 || highPlane[a] == -1) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Calcula las llegadas de todas las imágenes de una fuente y las acumula en los histogramas.
+	 * @param source Posición de la fuente
+	 * @param energy Energía de la fuente
+	 * @param loss Pérdida de energía por reflexión de la fuente
+	 * @param receptors Centros de los receptores
+	 * @param radio Radio de los receptores
+	 * @param histograms Histogramas de los receptores (uno por receptor)
+	 */
+	void run(const Point& source, float energy, float loss, const std::vector<Point>& receptors, double radio, std::vector<Histogram>& histograms) {
+		PROFILE_ZONE("ImageSource::run");
+		images = 0;
+		arrivals = 0;
+		if (!valid) {
+			std::cout << "La habitación no es una caja; se omite el método de fuentes imagen" << std::endl;
+			return;
+		}
+
+		double s[3] = { source.x, source.y, source.z };
+		int span = 2 * maxOrder + 1;
+
+		// Posición y factor de reflexión de cada índice de imagen por eje
+		std::vector<double> coord(3 * span);
+		std::vector<Bands> factor(3 * span);
+		Bands wallLow[3], wallHigh[3];
+		for (int a = 0; a < 3; a++) {
+			wallLow[a] = specularFactor(lowPlane[a], loss);
+			wallHigh[a] = specularFactor(highPlane[a], loss);
+		}
+
+		for (int a = 0; a < 3; a++) {
+			double L = high[a] - low[a];
+			double rel = s[a] - low[a];
+			for (int k = -maxOrder; k <= maxOrder; k++) {
+				int m = k < 0 ? -k : k;
+				bool even = (m % 2) == 0;
+				coord[a * span + k + maxOrder] = low[a] + (even ? k * L + rel : (k + 1) * L - rel);
+
+				// Con k > 0 se refleja primero en la pared superior; con k < 0, en la inferior
+				int first = (m + 1) / 2, second = m / 2;
+				Bands f = Bands(1.0f);
+				for (int r = 0; r < first; r++) f *= k > 0 ? wallHigh[a] : wallLow[a];
+				for (int r = 0; r < second; r++) f *= k > 0 ? wallLow[a] : wallHigh[a];
+				factor[a * span + k + maxOrder] = f;
+			}
+		}
+
+		double maxDistance = maxTime * V_SON;
+		float minEnergy = (float)threshold;
+		double r2 = radio * radio;
+
+		for (int i = -maxOrder; i <= maxOrder; i++) {
+			int ri = maxOrder - (i < 0 ? -i : i);
+			for (int j = -ri; j <= ri; j++) {
+				int rj = ri - (j < 0 ? -j : j);
+				for (int k = -rj; k <= rj; k++) {
+					Bands f = factor[i + maxOrder] * factor[span + j + maxOrder] * factor[2 * span + k + maxOrder];
+					if (f.peak() < minEnergy) {
+						continue;
+					}
+
+					double ix = coord[i + maxOrder], iy = coord[span + j + maxOrder], iz = coord[2 * span + k + maxOrder];
+					bool reached = false;
+					for (size_t r = 0; r < receptors.size(); r++) {
+						double vx = receptors[r].x - ix, vy = receptors[r].y - iy, vz = receptors[r].z - iz;
+						double d2 = vx * vx + vy * vy + vz * vz;
+						if (d2 > maxDistance * maxDistance) {
+							continue;
+						}
+						double d = sqrt(d2);
+						double t = d / V_SON;
+						double weight = crossover.early(t);
+						if (weight <= 0) {
+							continue;
+						}
+						histograms[r].add(t, f * (float)(weight * energy * r2 / (4 * d2)));
+						arrivals++;
+						reached = true;
+					}
+					images += reached ? 1 : 0;
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Devuelve el factor de reflexión especular por banda de un plano.
+	 * @details Combina la pérdida de la fuente, la absorción del material del plano y la fracción de energía
+	 * que no se dispersa.
+	 * @param plane Índice del plano
+	 * @param loss Pérdida de energía por reflexión de la fuente
+	 */
+	Bands specularFactor(int plane, float loss) {
+		const Material& m = room->materialAt(plane, 0);
+		return m.absorption.complement() * ((1.0f - loss) * (1.0f - m.scattering));
+	}
+};
+
+#endif // IMAGE_SOURCE_H
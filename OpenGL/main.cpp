@@ -1,4 +1,6 @@
 #include <iostream>
+#include <chrono>
+#include <sstream>
 
 const unsigned int SCR_WIDTH = 1280;
 const unsigned int SCR_HEIGHT = 720;
@@ -6,12 +8,717 @@ const unsigned int SCR_HEIGHT = 720;
 #include "utils.h"
 
 #include "room.h"
+#include "roomMesh.h"
+#include "simulation.h"
+#include "transferJob.h"
 #include "source.h"
 #include "receptor.h"
 #include "particle.h"
+#include "settings.h"
+#include "tracer.h"
+#include "imageSource.h"
+#include "hybrid.h"
+#include "scene.h"
+#include "sweep.h"
+#include "metrics.h"
+#include "auralizer.h"
+#include "bench.h"
+#include "counters.h"
+#include "checkpoint.h"
+
+#if defined(_MSC_VER) && defined(__AVX__)
+#include <intrin.h>
+#endif
+
+// Whether this processor runs the instruction set the build targets (Release x64 is built with /arch:AVX2). The check
+// must run before any other code, since the compiler may use those instructions anywhere, and it only uses integers
+bool cpuSupportsBuild()
+{
+#if defined(__AVX__) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	int leaves = info[0];
+	__cpuid(info, 1);
+	bool avx = (info[2] >> 27 & 1) && (info[2] >> 28 & 1) && (_xgetbv(0) & 6) == 6;
+#if defined(__AVX2__)
+	if (!avx || !(info[2] >> 12 & 1) || leaves < 7) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] >> 5 & 1) != 0;
+#else
+	return avx;
+#endif
+#elif defined(__AVX__)
+	__builtin_cpu_init();
+#if defined(__AVX2__)
+	if (!__builtin_cpu_supports("avx2")) {
+		return false;
+	}
+#endif
+#if defined(__FMA__)
+	if (!__builtin_cpu_supports("fma")) {
+		return false;
+	}
+#endif
+	return __builtin_cpu_supports("avx") != 0;
+#else
+	return true;
+#endif
+}
+
+// Material table from the command line
+void applyMaterials(Room& room, const Settings& settings)
+{
+	room.materials[0].scattering = settings.scattering;
+	if (settings.materials) {
+		room.loadMaterials(settings.materials);
+	}
+}
+
+// Receptor centres of the grid, with the same translation the rendered receptors use
+std::vector<Point> receptorCenters(const Settings& settings)
+{
+	std::vector<Point> receptors = Receptor::grid(settings.receptors);
+	for (size_t i = 0; i < receptors.size(); i++) {
+		receptors[i] = receptors[i] + errorTranslation;
+	}
+	return receptors;
+}
+
+// Acoustic parameters of every receptor, written next to the histograms and summarised per band on the console
+void reportMetrics(const char* prefix, const std::vector<Histogram>& histograms, int threads)
+{
+	auto start = std::chrono::steady_clock::now();
+	Metrics metrics = Metrics(histograms, threads);
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "Parametros acusticos de " << metrics.numReceptors << " receptores en " << elapsed * 1000 << " ms (media por banda)" << std::endl;
+	std::cout << "  Hz\tEDT\tT20\tT30\tC50\tC80\tD50\tTs" << std::endl;
+	for (int b = 0; b < NUM_BANDS; b++) {
+		std::cout << "  " << BAND_FREQUENCIES[b];
+		for (int m = 0; m < Metrics::COUNT; m++) {
+			std::cout << "\t" << metrics.mean(b, m);
+		}
+		std::cout << std::endl;
+	}
+
+	char filename[256];
+	snprintf(filename, sizeof(filename), "%s_metrics.csv", prefix);
+	std::cout << "Exportando parametros acusticos a " << filename << std::endl;
+	metrics.exportCSV(filename);
+}
+
+// Convolves the input WAV with the pressure impulse response of every receptor, one output WAV per receptor
+void auralize(const Settings& settings, const std::vector<Histogram>& histograms, int threads)
+{
+	WavReader probe(settings.auralize);
+	if (!probe.valid()) {
+		std::cout << "No se pudo leer " << settings.auralize << " como WAV" << std::endl;
+		return;
+	}
+	int rate = probe.sampleRate;
+	double duration = (double)probe.frames / rate;
+	probe.close();
+
+	auto start = std::chrono::steady_clock::now();
+	Auralizer auralizer = Auralizer(rate, FFT::nextPowerOfTwo(settings.auralizeBlock), settings.seed);
+	auralizer.build(histograms, threads);
+	double built = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "Auralizando " << settings.auralize << " (" << duration << " s) en " << settings.auralizeOutput << "_*.wav" << std::endl;
+	auralizer.run(settings.auralize, settings.auralizeOutput, threads);
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() - built;
+
+	std::cout << histograms.size() << " respuestas de " << (auralizer.responses.empty() ? 0 : auralizer.responses[0].size()) << " muestras en " << built << " s, convolucion en " << elapsed << " s (" << duration * histograms.size() / elapsed << "x tiempo real)" << std::endl;
+}
+
+// Counters and parameters of a finished run, written next to its results
+void exportRun(const char* filename, const CounterSnapshot& from, const CounterSnapshot& to, const Settings& settings, const char* mode, int threads)
+{
+	std::vector<std::pair<std::string, std::string>> info;
+	info.push_back(std::make_pair("mode", std::string(mode)));
+	info.push_back(std::make_pair("threads", std::to_string(threads)));
+	info.push_back(std::make_pair("n", std::to_string(settings.n)));
+	info.push_back(std::make_pair("rays", std::to_string(settings.rays)));
+	info.push_back(std::make_pair("sources", std::to_string(settings.sources.size())));
+	info.push_back(std::make_pair("receptors", std::to_string(settings.receptors)));
+	info.push_back(std::make_pair("seed", std::to_string(settings.seed)));
+	info.push_back(std::make_pair("precision", std::string(settings.precision)));
+	std::cout << "Exportando contadores de la ejecucion a " << filename << std::endl;
+	Counters::exportRun(filename, from, to, info);
+}
+
+// Everything that changes the result of a headless trace; a checkpoint is only resumed by a run with the same values
+uint64_t runFingerprint(const Settings& settings)
+{
+	std::ostringstream text;
+	text.precision(17);
+	text << "n=" << settings.n << ";materials=" << (settings.materials ? settings.materials : "") << ";scattering=" << settings.scattering
+		<< ";energy=" << settings.energy << ";loss=" << settings.loss << ";rays=" << settings.rays << ";chunk=" << settings.chunk
+		<< ";seed=" << settings.seed << ";receptors=" << settings.receptors << ";time=" << settings.maxTime << ";bin=" << settings.binWidth
+		<< ";threshold=" << settings.threshold << ";precision=" << settings.precision << ";hybrid=" << settings.hybrid
+		<< ";crossover=" << settings.crossover << ";fade=" << settings.fade;
+	for (size_t s = 0; s < settings.sources.size(); s++) {
+		text << ";source=" << settings.sources[s].x << "," << settings.sources[s].y << "," << settings.sources[s].z;
+	}
+	std::string fingerprint = text.str();
+	return Checkpoint::hash(fingerprint.data(), fingerprint.size());
+}
+
+// Headless ray tracing (or hybrid response) of every source; the room is built once and shared by all of them
+int runScene(const Settings& settings)
+{
+	const int faces = 6;
+	Room room = Room(settings.n, faces, 0, nullptr, TRANSFER_NONE);
+	applyMaterials(room, settings);
+
+	std::vector<Point> receptors = receptorCenters(settings);
+	Crossover crossover = settings.hybrid ? Crossover(settings.crossover, settings.fade) : Crossover();
+	Scene scene = Scene(room, receptors, Receptor::radioFor(1.0f), settings.binWidth, settings.maxTime, crossover, settings.chunk, settings.threshold);
+	scene.engine.tracer.singlePrecision = strcmp(settings.precision, "float") == 0;
+	for (size_t s = 0; s < settings.sources.size(); s++) {
+		scene.addSource(Emitter(settings.sources[s] + errorTranslation, settings.rays, settings.energy, settings.loss, settings.seed + s));
+	}
+
+	int threads = settings.threads > 0 ? settings.threads : defaultThreads();
+	bool reciprocal = strcmp(settings.direction, "reciprocal") == 0 || (strcmp(settings.direction, "auto") == 0 && scene.preferReciprocal(threads));
+
+	// Checkpoints are taken between passes of the forward trace, so a checkpointed run always traces forward
+	CheckpointWriter checkpoints(settings.checkpoint ? settings.checkpoint : "", runFingerprint(settings), settings.checkpointInterval);
+	if (settings.checkpoint) {
+		if (reciprocal && strcmp(settings.direction, "reciprocal") == 0) {
+			std::cout << "Los puntos de control solo se admiten en trazado directo; se traza en sentido directo" << std::endl;
+		}
+		reciprocal = false;
+
+		Checkpoint saved;
+		if (settings.resume && saved.load(settings.checkpoint, checkpoints.fingerprint)) {
+			if (!scene.load(saved)) {
+				std::cout << "El punto de control " << settings.checkpoint << " no es valido para esta escena" << std::endl;
+				return 1;
+			}
+			std::cout << "Reanudando desde " << settings.checkpoint << ": fuente " << scene.responses.size() + 1 << " de " << scene.sources.size() << ", "
+				<< scene.sources[scene.responses.size()].emitted << " rayos emitidos" << std::endl;
+		}
+		else if (settings.resume) {
+			std::cout << "No hay un punto de control valido en " << settings.checkpoint << "; se empieza desde el principio" << std::endl;
+		}
+
+		checkpoints.capture = [&scene](Checkpoint& c) { scene.save(c); };
+		scene.engine.tracer.checkpoints = &checkpoints;
+		checkpoints.start();
+	}
+
+	CounterSnapshot before = Counters::read();
+	StatusLine status(1.0);
+	auto start = std::chrono::steady_clock::now();
+	if (reciprocal) {
+		scene.runReciprocal(threads);
+	}
+	else {
+		scene.run();
+	}
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	status.stop();
+	checkpoints.stop();
+	CounterSnapshot after = Counters::read();
+
+	std::cout << (reciprocal ? "Trazado reciproco: " : "Trazado directo: ") << scene.sources.size() << " fuentes, " << scene.engine.images << " imagenes, " << scene.engine.rays << " rayos en " << elapsed << " s" << std::endl;
+	if (settings.checkpoint) {
+		std::cout << checkpoints.written << " puntos de control escritos en " << settings.checkpoint << std::endl;
+	}
+
+	const char* prefix = settings.hybrid ? "csv/hybridReceptors" : "csv/traceReceptors";
+	if (scene.sources.size() > 1) {
+		std::cout << "Exportando histogramas de cada fuente a " << prefix << "_source*_*.csv" << std::endl;
+		scene.exportCSV(prefix);
+	}
+	std::cout << "Exportando histogramas combinados por banda a " << prefix << "_*.csv" << std::endl;
+	std::vector<Histogram> combined = scene.combine(settings.gains);
+	Histogram::exportCSV(prefix, combined);
+
+	char filename[256];
+	snprintf(filename, sizeof(filename), "%s_run.csv", prefix);
+	exportRun(filename, before, after, settings, reciprocal ? "reciprocal" : "forward", threads);
+
+	reportMetrics(prefix, combined, threads);
+	if (settings.auralize) {
+		auralize(settings, combined, threads);
+	}
+	return 0;
+}
+
+// Traces the same scene in double and in float and reports how far the float results are from the double ones.
+// A second double run with another seed gives the Monte Carlo noise the float error should be compared with.
+int runPrecision(const Settings& settings)
+{
+	const int faces = 6;
+	Room room = Room(settings.n, faces, 0, nullptr, TRANSFER_NONE);
+	applyMaterials(room, settings);
+
+	std::vector<Point> receptors = receptorCenters(settings);
+	Crossover crossover = settings.hybrid ? Crossover(settings.crossover, settings.fade) : Crossover();
+	int threads = settings.threads > 0 ? settings.threads : defaultThreads();
+
+	const char* names[3] = { "double", "float", "double (otra semilla)" };
+	std::vector<Histogram> results[3];
+	double seconds[3];
+	for (int k = 0; k < 3; k++) {
+		Scene scene = Scene(room, receptors, Receptor::radioFor(1.0f), settings.binWidth, settings.maxTime, crossover, settings.chunk, settings.threshold);
+		scene.engine.tracer.singlePrecision = k == 1;
+		uint64_t seed = k == 2 ? settings.seed + 1000003 : settings.seed;
+		for (size_t s = 0; s < settings.sources.size(); s++) {
+			scene.addSource(Emitter(settings.sources[s] + errorTranslation, settings.rays, settings.energy, settings.loss, seed + s));
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		scene.run();
+		seconds[k] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		results[k] = scene.combine(settings.gains);
+		std::cout << names[k] << ": " << scene.engine.rays << " rayos en " << seconds[k] << " s" << std::endl;
+	}
+	std::cout << "Aceleracion de float: " << seconds[0] / seconds[1] << "x" << std::endl;
+
+	// Rounding alone: the same rays from the source, first wall and distance in both precisions
+	Tracer tracer = Tracer(room, receptors, Receptor::radioFor(1.0f), settings.binWidth, settings.maxTime, settings.chunk);
+	Emitter probe = Emitter(settings.sources[0] + errorTranslation, settings.chunk, settings.energy, settings.loss, settings.seed);
+	Emitter probeFloat = probe;
+	int count = probe.emit(tracer.batch);
+	probeFloat.emit(tracer.batchFloat);
+	nearestWalls(tracer.walls.data(), (int)tracer.walls.size(), tracer.batch, 0, count);
+	nearestWalls(tracer.wallsFloat.data(), (int)tracer.wallsFloat.size(), tracer.batchFloat, 0, count);
+	int sameWall = 0;
+	double maxError = 0;
+	for (int i = 0; i < count; i++) {
+		if (tracer.batch.wall[i] == tracer.batchFloat.wall[i]) {
+			sameWall++;
+			maxError = fmax(maxError, fabs(tracer.batchFloat.hitTime[i] - tracer.batch.hitTime[i]) / tracer.batch.hitTime[i]);
+		}
+	}
+	std::cout << "Primera reflexion de " << count << " rayos: mismo plano en " << 100.0 * sameWall / count << "%, error relativo maximo de la distancia " << maxError << std::endl;
+
+	// Early part: the order derived from the crossover must already contain every specular path before the fade ends,
+	// so a much higher order has to give the same energy
+	if (settings.hybrid) {
+		Hybrid engine = Hybrid(room, receptors, Receptor::radioFor(1.0f), settings.binWidth, settings.maxTime, crossover, settings.chunk, settings.threshold);
+		if (engine.imageSource.valid) {
+			int orders[2] = { engine.imageSource.maxOrder, engine.imageSource.maxOrder + 8 };
+			double early[2] = { 0, 0 };
+			long long images[2] = { 0, 0 };
+			for (int k = 0; k < 2; k++) {
+				std::vector<Histogram> histograms(receptors.size(), Histogram(settings.binWidth, settings.maxTime));
+				engine.imageSource.maxOrder = orders[k];
+				engine.imageSource.run(settings.sources[0] + errorTranslation, settings.energy, settings.loss, receptors, engine.radio, histograms);
+				images[k] = engine.imageSource.images;
+				for (size_t r = 0; r < histograms.size(); r++) {
+					for (int b = 0; b < NUM_BANDS; b++) {
+						early[k] += histograms[r].total(b);
+					}
+				}
+			}
+			double difference = early[1] > 0 ? fabs(early[1] - early[0]) / early[1] : 0;
+			std::cout << "Parte temprana: orden " << orders[0] << " (" << images[0] << " imagenes) frente a orden " << orders[1] << " (" << images[1]
+				<< " imagenes), diferencia relativa de energia " << difference << (difference > 1e-9 ? " - AVISO: el orden de la transicion pierde caminos" : "") << std::endl;
+		}
+	}
+
+	// Mean absolute difference to the double run, per band, of the received energy and the acoustic parameters
+	Metrics metrics[3] = { Metrics(results[0], threads), Metrics(results[1], threads), Metrics(results[2], threads) };
+	const int compared[4] = { Metrics::EDT, Metrics::T30, Metrics::C80, Metrics::D50 };
+	const char* comparedNames[4] = { "EDT", "T30", "C80", "D50" };
+
+	FILE* file;
+	if (fopen_s(&file, "csv/precision.csv", "w") != 0) {
+		perror("Error al abrir el archivo");
+		return 1;
+	}
+	fprintf(file, "band,quantity,float,noise\n");
+	std::cout << "Diferencia media con double (float / otra semilla):" << std::endl;
+	std::cout << "  Hz\tenergia %\tEDT s\tT30 s\tC80 dB\tD50" << std::endl;
+	for (int b = 0; b < NUM_BANDS; b++) {
+		double energy[3] = { 0, 0, 0 };
+		for (int k = 0; k < 3; k++) {
+			for (size_t r = 0; r < results[k].size(); r++) {
+				energy[k] += results[k][r].total(b);
+			}
+		}
+		double energyFloat = 100 * fabs(energy[1] - energy[0]) / energy[0];
+		double energyNoise = 100 * fabs(energy[2] - energy[0]) / energy[0];
+		fprintf(file, "%g,energyPercent,%.6f,%.6f\n", BAND_FREQUENCIES[b], energyFloat, energyNoise);
+		std::cout << "  " << BAND_FREQUENCIES[b] << "\t" << energyFloat << " / " << energyNoise;
+
+		for (int m = 0; m < 4; m++) {
+			double diff[2] = { 0, 0 };
+			int valid[2] = { 0, 0 };
+			for (int r = 0; r < metrics[0].numReceptors; r++) {
+				double ref = metrics[0].at(r, b, compared[m]);
+				for (int k = 1; k < 3; k++) {
+					double d = fabs(metrics[k].at(r, b, compared[m]) - ref);
+					if (std::isfinite(d)) {
+						diff[k - 1] += d;
+						valid[k - 1]++;
+					}
+				}
+			}
+			double diffFloat = valid[0] ? diff[0] / valid[0] : NAN;
+			double diffNoise = valid[1] ? diff[1] / valid[1] : NAN;
+			fprintf(file, "%g,%s,%.6f,%.6f\n", BAND_FREQUENCIES[b], comparedNames[m], diffFloat, diffNoise);
+			std::cout << "\t" << diffFloat << " / " << diffNoise;
+		}
+		std::cout << std::endl;
+	}
+	fclose(file);
+	std::cout << "Exportando informe de precision a csv/precision.csv" << std::endl;
+	return 0;
+}
+
+// Headless image-source method: deterministic early reflections of a box room
+int runImages(const Settings& settings)
+{
+	const int faces = 6;
+	Room room = Room(settings.n, faces, 0, nullptr, TRANSFER_NONE);
+	applyMaterials(room, settings);
+
+	std::vector<Point> receptors = receptorCenters(settings);
+
+	std::vector<Histogram> histograms(receptors.size(), Histogram(settings.binWidth, settings.maxTime));
+	ImageSource imageSource = ImageSource(room, settings.imageOrder, settings.maxTime, settings.threshold);
+
+	long long images = 0, arrivals = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t s = 0; s < settings.sources.size(); s++) {
+		float gain = s < settings.gains.size() ? (float)settings.gains[s] : 1.0f;
+		imageSource.run(settings.sources[s] + errorTranslation, gain * settings.energy, settings.loss, receptors, Receptor::radioFor(1.0f), histograms);
+		images += imageSource.images;
+		arrivals += imageSource.arrivals;
+	}
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << images << " imagenes, " << arrivals << " llegadas en " << elapsed << " s" << std::endl;
+	std::cout << "Exportando histogramas de fuentes imagen por banda a csv/imageReceptors_*.csv" << std::endl;
+	Histogram::exportCSV("csv/imageReceptors", histograms);
+	int threads = settings.threads > 0 ? settings.threads : defaultThreads();
+	reportMetrics("csv/imageReceptors", histograms, threads);
+	if (settings.auralize) {
+		auralize(settings, histograms, threads);
+	}
+	return 0;
+}
+
+// Headless parameter sweep: one room per distinct n, configurations spread across threads, one results file
+int runSweep(const Settings& settings)
+{
+	Sweep sweep;
+	for (size_t i = 0; i < settings.sweepN.size(); i++) sweep.ns.push_back((int)settings.sweepN[i]);
+	for (size_t i = 0; i < settings.sweepLoss.size(); i++) sweep.losses.push_back((float)settings.sweepLoss[i]);
+	for (size_t i = 0; i < settings.sweepEnergy.size(); i++) sweep.energies.push_back((float)settings.sweepEnergy[i]);
+	for (size_t i = 0; i < settings.sweepRays.size(); i++) sweep.rays.push_back((long long)settings.sweepRays[i]);
+	if (sweep.ns.empty()) sweep.ns.push_back(settings.n);
+	if (sweep.losses.empty()) sweep.losses.push_back(settings.loss);
+	if (sweep.energies.empty()) sweep.energies.push_back(settings.energy);
+	if (sweep.rays.empty()) sweep.rays.push_back(settings.rays);
+
+	for (size_t s = 0; s < settings.sources.size(); s++) {
+		sweep.sources.push_back(settings.sources[s] + errorTranslation);
+	}
+	sweep.gains = settings.gains;
+	sweep.receptors = receptorCenters(settings);
+	sweep.radio = Receptor::radioFor(1.0f);
+	sweep.binWidth = settings.binWidth;
+	sweep.maxTime = settings.maxTime;
+	sweep.crossover = settings.hybrid ? Crossover(settings.crossover, settings.fade) : Crossover();
+	sweep.chunkSize = settings.chunk;
+	sweep.threshold = settings.threshold;
+	sweep.seed = settings.seed;
+	sweep.singlePrecision = strcmp(settings.precision, "float") == 0;
+
+	int threads = settings.threads > 0 ? settings.threads : defaultThreads();
+	CounterSnapshot before = Counters::read();
+	StatusLine status(1.0);
+	auto start = std::chrono::steady_clock::now();
+	sweep.run(threads, [&](Room& room) { applyMaterials(room, settings); });
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	status.stop();
+	CounterSnapshot after = Counters::read();
+
+	std::cout << sweep.results.size() << " configuraciones en " << elapsed << " s con " << threads << " hilos" << std::endl;
+	std::cout << "Exportando resultados del barrido a " << settings.sweepOutput << std::endl;
+	sweep.exportCSV(settings.sweepOutput);
+
+	std::string run = settings.sweepOutput;
+	size_t dot = run.rfind(".csv");
+	run = (dot != std::string::npos ? run.substr(0, dot) : run) + "_run.csv";
+	exportRun(run.c_str(), before, after, settings, "sweep", threads);
+	return 0;
+}
+
+// Prints one self-check and returns whether it passed
+bool check(const char* name, double value, double expected, double tolerance)
+{
+	bool passed = fabs(value - expected) <= tolerance;
+	if (!passed) {
+		std::cout << "FALLO " << name << ": " << value << ", se esperaba " << expected << std::endl;
+	}
+	return passed;
+}
+
+// Deterministic checks of the signal code against inputs with a known answer, run before the benchmarks
+bool runChecks(uint64_t seed)
+{
+	Random rng = Random::forStream(seed, 1);
+	bool passed = true;
+
+	// FFT: an impulse has a flat spectrum, and forward followed by inverse returns the input
+	const int n = 256;
+	FFT fft = FFT(n);
+	std::vector<std::complex<float>> x(n), y(n);
+	x[0] = 1.0f;
+	fft.forward(x.data());
+	double flat = 0;
+	for (int k = 0; k < n; k++) flat = fmax(flat, std::abs(x[k] - std::complex<float>(1.0f, 0.0f)));
+	passed = check("FFT impulso", flat, 0, 1e-6) && passed;
+	for (int i = 0; i < n; i++) x[i] = y[i] = std::complex<float>((float)(2 * rng.nextDouble() - 1), (float)(2 * rng.nextDouble() - 1));
+	fft.forward(x.data());
+	fft.inverse(x.data());
+	double roundTrip = 0;
+	for (int i = 0; i < n; i++) roundTrip = fmax(roundTrip, std::abs(x[i] - y[i]));
+	passed = check("FFT ida y vuelta", roundTrip, 0, 1e-5) && passed;
+
+	// Convolver: a unit impulse returns the input, and two taps in different partitions give 0.5 x[i] - 0.25 x[i - 100]
+	const int block = 64, blocks = 8;
+	std::vector<float> input(block * blocks), output(block * blocks);
+	for (size_t i = 0; i < input.size(); i++) input[i] = (float)(2 * rng.nextDouble() - 1);
+	std::vector<float> taps(101, 0.0f);
+	taps[0] = 0.5f;
+	taps[100] = -0.25f;
+	const std::vector<float> responses[2] = { std::vector<float>(1, 1.0f), taps };
+	const char* names[2] = { "Convolver impulso", "Convolver dos coeficientes" };
+	for (int r = 0; r < 2; r++) {
+		Convolver convolver = Convolver(responses[r], block);
+		for (int j = 0; j < blocks; j++) {
+			convolver.process(&input[j * block], &output[j * block]);
+		}
+		double error = 0;
+		for (int i = 0; i < block * blocks; i++) {
+			double expected = 0;
+			for (int k = 0; k < (int)responses[r].size() && k <= i; k++) expected += responses[r][k] * input[i - k];
+			error = fmax(error, fabs(output[i] - expected));
+		}
+		passed = check(names[r], error, 0, 1e-5) && passed;
+	}
+
+	// Metrics: an ideal exponential decay starting 10 ms in, with a different reverberation time in each band. Its
+	// Schroeder curve is the same exponential, so EDT, T20 and T30 equal that time, and the clarity, definition and
+	// centre time have closed forms in the ratio r between consecutive bins
+	const double width = 0.001;
+	Histogram decay = Histogram(width, 4.0);
+	double reverberation[NUM_BANDS];
+	for (int b = 0; b < NUM_BANDS; b++) {
+		reverberation[b] = 0.5 + 0.25 * b;
+		for (int i = 10; i < decay.numBins; i++) {
+			decay.energy[(size_t)i * NUM_BANDS + b] = exp(-6 * log(10.0) * (i - 10) * width / reverberation[b]);
+		}
+	}
+	std::vector<double> values(NUM_BANDS * Metrics::COUNT);
+	Metrics::compute(decay, values.data());
+	for (int b = 0; b < NUM_BANDS; b++) {
+		double r = exp(-6 * log(10.0) * width / reverberation[b]);
+		const double* v = &values[b * Metrics::COUNT];
+		passed = check("Metrics EDT", v[Metrics::EDT], reverberation[b], 0.005 * reverberation[b]) && passed;
+		passed = check("Metrics T20", v[Metrics::T20], reverberation[b], 0.005 * reverberation[b]) && passed;
+		passed = check("Metrics T30", v[Metrics::T30], reverberation[b], 0.005 * reverberation[b]) && passed;
+		passed = check("Metrics C50", v[Metrics::C50], 10 * log10(1 / pow(r, 50) - 1), 0.01) && passed;
+		passed = check("Metrics C80", v[Metrics::C80], 10 * log10(1 / pow(r, 80) - 1), 0.01) && passed;
+		passed = check("Metrics D50", v[Metrics::D50], 1 - pow(r, 50), 1e-4) && passed;
+		passed = check("Metrics Ts", v[Metrics::TS], width * (r / (1 - r) + 0.5), 1e-4) && passed;
+	}
+
+	std::cout << (passed ? "Comprobaciones de FFT, Convolver y Metrics correctas" : "Hay comprobaciones con fallos") << std::endl;
+	return passed;
+}
+
+// Microbenchmarks of the geometry and collision hot paths; inputs come from fixed seeds so runs are comparable. The
+// self-checks run first, and a failed one makes the run return 1
+int runBench(const Settings& settings)
+{
+	bool checked = runChecks(settings.seed);
+
+	// Receptors and sources fetch their shaders on construction, so a hidden context is needed
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "Bench", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	Bench bench = Bench(settings.benchTime);
+	Random rng = Random::forStream(settings.seed, 0);
+	const int N = 1024;
+
+	// Vect
+	std::vector<Vect> a, b;
+	for (int i = 0; i < N; i++) {
+		a.push_back(Vect(Point(4 * rng.nextDouble() - 2, 4 * rng.nextDouble() - 2, 4 * rng.nextDouble() - 2)));
+		b.push_back(Vect(Point(4 * rng.nextDouble() - 2, 4 * rng.nextDouble() - 2, 4 * rng.nextDouble() - 2)));
+	}
+	bench.run("Vect::operator* (dot)", N, [&]() { double s = 0; for (int i = 0; i < N; i++) s += a[i] * b[i]; return s; });
+	bench.run("Vect::operator^ (cross)", N, [&]() { double s = 0; for (int i = 0; i < N; i++) s += (a[i] ^ b[i]).getI(); return s; });
+	bench.run("Vect::unit", N, [&]() { double s = 0; for (int i = 0; i < N; i++) s += a[i].unit().getI(); return s; });
+	bench.run("Vect::rodriges", N, [&]() { double s = 0; for (int i = 0; i < N; i++) s += Vect::rodriges(a[i], b[i], 0.3).getI(); return s; });
+
+	// Vec3, same inputs
+	std::vector<Vec3> u(a.begin(), a.end()), v(b.begin(), b.end());
+	bench.run("Vec3::dot", N, [&]() { double s = 0; for (int i = 0; i < N; i++) s += u[i].dot(v[i]); return s; });
+	bench.run("Vec3::cross", N, [&]() { double s = 0; for (int i = 0; i < N; i++) s += u[i].cross(v[i]).x; return s; });
+	bench.run("Vec3::unit", N, [&]() { double s = 0; for (int i = 0; i < N; i++) s += u[i].unit().x; return s; });
+	bench.run("Vec3::rotate", N, [&]() { double s = 0; for (int i = 0; i < N; i++) s += v[i].rotate(u[i].unit(), 0.3).x; return s; });
+
+	// Receptors and room as in the interactive window
+	std::vector<Point> receptorGrid = Receptor::grid(settings.receptors);
+	Receptor* receptors = new Receptor[receptorGrid.size()];
+	for (size_t l = 0; l < receptorGrid.size(); l++) {
+		receptors[l] = Receptor(receptorGrid[l], 1.0f);
+		receptors[l].setID(l);
+	}
+	// Same matrices as the window builds, but without writing them over the csv files of the last interactive run
+	Room room = Room(settings.n, 6, (int)receptorGrid.size(), receptors, TRANSFER_NONE);
+	std::vector<Triangle> roomTriangles = room.indexTriangles();
+	room.transferMatrix(roomTriangles, room.energyRoom, nullptr, false);
+	room.receptorTrans(roomTriangles, false);
+	applyMaterials(room, settings);
+
+	// Rays leaving the room through a random point of its surface
+	std::vector<Point> start(N);
+	std::vector<Vec3> direction(N);
+	for (int i = 0; i < N; i++) {
+		double x, y, z;
+		rng.nextDirection(x, y, z);
+		double m = fmax(fabs(x), fmax(fabs(y), fabs(z)));
+		start[i] = Point(x / m * 2.02, y / m * 2.02, z / m * 2.02);
+		direction[i] = Vec3(x, y, z);
+	}
+
+	Plane& plane = room.planes[0];
+	bench.run("Plane::reflect", N, [&]() { double s = 0; for (int i = 0; i < N; i++) s += plane.reflect(direction[i]).x; return s; });
+	bench.run("Plane::incidence", N, [&]() { double s = 0; for (int i = 0; i < N; i++) s += plane.incidence(start[i], direction[i]).x; return s; });
+	bench.run("Room::nearestSurpassedPlaneIndex", N, [&]() { double s = 0; for (int i = 0; i < N; i++) s += room.nearestSurpassedPlaneIndex(start[i], direction[i]); return s; });
+
+	// Nearest wall of a whole batch of rays, in both precisions (AVX processes eight float rays at a time)
+	Tracer tracer = Tracer(room, receptorGrid, Receptor::radioFor(1.0f), settings.binWidth, settings.maxTime, N);
+	Emitter probe = Emitter(Point(0, 0, 0), N, 1.0f, 0.0f, settings.seed);
+	Emitter probeFloat = probe;
+	probe.emit(tracer.batch);
+	probeFloat.emit(tracer.batchFloat);
+	bench.run("nearestWalls<double>", N, [&]() { nearestWalls(tracer.walls.data(), (int)tracer.walls.size(), tracer.batch, 0, N); return tracer.batch.hitTime[0]; });
+	bench.run("nearestWalls<float>", N, [&]() { nearestWalls(tracer.wallsFloat.data(), (int)tracer.wallsFloat.size(), tracer.batchFloat, 0, N); return tracer.batchFloat.hitTime[0]; });
+
+	std::vector<Particle> particles(N, Particle(1.0, settings.loss, Point(0, 0, 0), Vec3(1, 0, 0)));
+	bench.run("Room::handleParticleCollision", N, [&]() {
+		double s = 0;
+		for (int i = 0; i < N; i++) {
+			Particle& p = particles[i];
+			p.position = start[i];
+			p.incidence = direction[i];
+			p.bands = Bands(1.0f);
+			p.energy = 1.0;
+			p.alive = true;
+			room.handleParticleCollision(p);
+			s += p.position.x;
+		}
+		return s;
+	});
+
+	Receptor& receptor = room.receptors[0];
+	float currentTime = 0;
+	for (int i = 0; i < N; i++) {
+		particles[i].position = receptor.position + Point(0.5 * receptor.radio * (2 * rng.nextDouble() - 1), 0, 0);
+		particles[i].lastTriangle = i % (room.numPlanes * room.numTriangles);
+	}
+	bench.run("Receptor::handleParticleCollision", N, [&]() {
+		for (int i = 0; i < N; i++) {
+			particles[i].lastReceptor = -1;
+			currentTime += 1e-3f;
+			receptor.handleParticleCollision(particles[i], currentTime, false);
+		}
+		return receptor.energy;
+	});
+
+	// Solid angle between random pairs of triangles of different planes
+	std::vector<Triangle*> from(N), to(N);
+	for (int i = 0; i < N; i++) {
+		int p = (int)(rng.nextDouble() * room.numPlanes);
+		int q = (p + 1 + (int)(rng.nextDouble() * (room.numPlanes - 1))) % room.numPlanes;
+		from[i] = &room.planes[p].triangles[(int)(rng.nextDouble() * room.numTriangles)];
+		to[i] = &room.planes[q].triangles[(int)(rng.nextDouble() * room.numTriangles)];
+	}
+	bench.run("Room::solidAngle", N, [&]() { double s = 0; for (int i = 0; i < N; i++) s += room.solidAngle(*from[i], *to[i], 0.2); return s; });
+
+	// Full energy transfer matrix, without the CSV export (disk time is not part of the computation)
+	for (size_t k = 0; k < settings.benchN.size(); k++) {
+		int n = (int)settings.benchN[k];
+		Room sized = Room(n, 6, 0, nullptr, TRANSFER_NONE);
+		std::vector<Triangle> triangles = sized.indexTriangles();
+		int dim = (int)triangles.size();
+		double** matrix = new double* [dim];
+		bench.run("Room::transferMatrix n=" + std::to_string(n), (long long)dim * dim, [&]() {
+			sized.transferMatrix(triangles, matrix, nullptr, false);
+			double value = matrix[0][1];
+			for (int i = 0; i < dim; i++) {
+				delete[] matrix[i];
+			}
+			return value;
+		});
+		delete[] matrix;
+	}
 
-int main()
+	std::cout << "Exportando resultados a csv/bench.csv" << std::endl;
+	bench.exportCSV("csv/bench.csv");
+	ShaderCache::clear();
+	glfwTerminate();
+	return checked ? 0 : 1;
+}
+
+int main(int argc, char** argv)
 {
+	if (!cpuSupportsBuild()) {
+#if defined(__AVX2__)
+		std::cout << "Este ejecutable usa instrucciones AVX2 y este procesador no las admite; compila sin /arch:AVX2" << std::endl;
+#else
+		std::cout << "Este ejecutable usa instrucciones AVX y este procesador no las admite; compila sin /arch:AVX" << std::endl;
+#endif
+		return 1;
+	}
+	Settings settings = Settings::parse(argc, argv);
+	PROFILE_OUTPUT("csv/trace.json");
+	if (settings.bench) {
+		return runBench(settings);
+	}
+	if (settings.sweep) {
+		return runSweep(settings);
+	}
+	if ((settings.trace || settings.hybrid) && strcmp(settings.precision, "compare") == 0) {
+		return runPrecision(settings);
+	}
+	if (settings.trace || settings.hybrid) {
+		return runScene(settings);
+	}
+	if (settings.images) {
+		return runImages(settings);
+	}
+
 	glfwInit();
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -44,73 +751,72 @@ int main()
 	}
 
 	// Receptors
-	int RECEPTORS = 27; // 3, 9, 27, 81, 243, 729, 2187
-	int receptorsPerSide = pow(RECEPTORS, 1.0f / 3.0f);
-	float receptorDelta = (2 * 1) / (receptorsPerSide - static_cast<float>(1));
+	int RECEPTORS = settings.receptors; // 3, 9, 27, 81, 243, 729, 2187
+	std::vector<Point> receptorGrid = Receptor::grid(RECEPTORS);
 	Receptor* receptors = new Receptor[RECEPTORS];
-	int l = 0;
-	for (float i = 0; i < receptorsPerSide; i += 1) {
-		for (float j = 0; j < receptorsPerSide; j += 1) {
-			for (float k = 0; k < receptorsPerSide; k += 1) {
-				//Receptor rec = Receptor({ -1.6 + i * receptorDelta, -1.6 + j * (receptorDelta - 0.4), -1.6 + k * receptorDelta }, 1.0f);
-				Receptor rec = Receptor({ -1 + i * receptorDelta, -1 + j * (receptorDelta), -1 + k * receptorDelta }, 1.0f);
-				rec.setID(l);
-				receptors[l] = rec;
-				l++;
-			}
-		}
+	for (int l = 0; l < RECEPTORS; l++) {
+		Receptor rec = Receptor(receptorGrid[l], 1.0f);
+		rec.setID(l);
+		receptors[l] = rec;
 	}
 
 	// Triangle numbers
-	const int n = 242; // 2, 8, 18, 32, 50, 2n*n, 800, 1800
-	// El lmite es 242 si se quiere calcular la transferencia de energa
-	// se recomienda usar 128 para un rendimiento ptimo
+	const int n = settings.n; // 2, 8, 18, 32, 50, 2n*n, 800, 1800
+	// El límite es 242 si se quiere calcular la transferencia de energía
+	// se recomienda usar 128 para un rendimiento óptimo
 	const int faces = 6;
 
-	Room room = Room(n, faces, RECEPTORS, receptors);
+	// The room starts with the approximate energy matrix so the first frame does not wait for energyTrans; the full
+	// matrix is computed in the background and the simulation switches to it when it is ready
+	Room room = Room(n, faces, RECEPTORS, receptors, TRANSFER_APPROXIMATE);
+	applyMaterials(room, settings);
+	TransferJob transfer;
+	transfer.start(&room);
 
-	const int tnt = n * faces;
-	double** toDraw = room.getAllVertices();
-	double allVertices[n * faces][9]{};
-	for (int i = 0; i < n * faces; i++) {
-		for (int j = 0; j < 9; j++) {
-			allVertices[i][j] = toDraw[i][j];
-		}
-	}
-	delete[] toDraw;
-
-	unsigned int VBO[tnt], VAO[tnt];
-	glGenVertexArrays(tnt, VAO);
-	glGenBuffers(tnt, VBO);
-
-
-	for (int i = 0; i < tnt; i++) {
-		glBindVertexArray(VAO[i]);
-		glBindBuffer(GL_ARRAY_BUFFER, VBO[i]);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(allVertices[i]), allVertices[i], GL_STATIC_DRAW);
-		glVertexAttribPointer(0, 3, GL_DOUBLE, GL_FALSE, 3 * sizeof(double), (void*)0);
-		glEnableVertexAttribArray(0);
-	}
-
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
-
-	Shader roomShader("shaders/room.vs", "shaders/room.fs");
+	// The whole room is one mesh drawn with a single call
+	RoomMesh roomMesh;
+	roomMesh.init(room);
 
 	Particle::initParticleBuffers();
 	Source::initSourceBuffers();
 	Receptor::initReceptorBuffers();
 
-	int MAX_PARTICLES = 800; // Se recomienda usar 400 para un rendimiento ptimo
-	float ENERGY = 800;
-	float LOSS = 0.2;
+	int MAX_PARTICLES = settings.maxParticles; // Se recomienda usar 400 para un rendimiento óptimo
+	float ENERGY = settings.energy;
+	float LOSS = settings.loss;
+
+	// All sources share the same room, receptors and energy matrices
+	std::vector<Source> sources;
+	for (size_t s = 0; s < settings.sources.size(); s++) {
+		Source source = Source(settings.sources[s], MAX_PARTICLES, ENERGY, LOSS);
+		source.setID(s);
+		source.setEnergyFloor(settings.threshold);
+		sources.push_back(source);
+	}
+
+	// Receptor hits are queued per receptor and appended to csv/receptors by a background thread; the queues hold
+	// the hits of a whole drain interval and belong to the writer
+	HitWriter hitWriter;
+	unsigned hitCapacity = hitWriter.capacityFor(MAX_PARTICLES * (int)sources.size(), settings.simRate);
+	for (int l = 0; l < RECEPTORS; l++) {
+		receptors[l].hits = hitWriter.add(receptors[l].hitsFilename(), hitCapacity);
+	}
+	hitWriter.start();
+
+	// The simulation runs on its own thread at a fixed step, in real time or as fast as the frame budget allows;
+	// the window draws the latest snapshot it published
+	Simulation simulation(&room, receptors, RECEPTORS, &sources, settings.simRate, settings.simBudget);
+	simulation.transfer = &transfer;
+	simulation.start();
 
-	//Source source = Source({ 0, 0, 0 }, MAX_PARTICLES, ENERGY, LOSS);
-	Source source2 = Source({ 1.6, 1.6, -1.6 }, MAX_PARTICLES, ENERGY, LOSS);
+	// Throughput shown in the window title, refreshed twice a second
+	const std::string title = "Bounces - G1 [Cristian Bastidas, Julio Mora, Erick Vera, Jonathan Gonzalez]";
+	CounterSnapshot lastCounters = Counters::read();
 
 	// RENDER LOOP
 	while (!glfwWindowShouldClose(window))
 	{
+		PROFILE_ZONE("Frame");
 		float currentFrame = static_cast<float>(glfwGetTime());
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
@@ -119,63 +825,84 @@ int main()
 		glClearColor(30.0f / 255.0f, 30.0f / 255.0f, 30.0f / 255.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
 
-		// Room
-		roomShader.use();
-		glm::mat4 model = glm::mat4(1.0f);
+		simulation.running.store(particlesState);
 		glm::mat4 view = camera.GetViewMatrix();
 		glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-		roomShader.setMat4("model", model);
-		roomShader.setMat4("view", view);
-		roomShader.setMat4("projection", projection);
 
-		std::vector<glm::vec4> roomColors = room.getTriangleColors();
-		for (int i = 0; i < tnt; i++) {
-			roomShader.setVec4("triangle_color", roomColors[i]);
-			glBindVertexArray(VAO[i]);
-			glDrawArrays(GL_TRIANGLES, 0, 3);
+		// Latest published state; the simulation keeps running while it is drawn
+		if (simulation.snapshots.update()) {
+			const SimulationSnapshot& snapshot = simulation.snapshots.read();
+			roomMesh.update(snapshot.triangleEnergy.data(), snapshot.dirtyBegin, snapshot.dirtyEnd);
+			simulation.drawn.store(snapshot.sequence, std::memory_order_release);
 		}
+		const SimulationSnapshot& snapshot = simulation.snapshots.read();
 
-
-		if (!particlesState) {
-			deltaTime = 0;
+		// Room: only the triangles that received energy since the last snapshot are uploaded
+		{
+			PROFILE_ZONE("Render room");
+			roomMesh.draw(view, projection);
 		}
 
 		// Receptors
-		for (int i = 0; i < RECEPTORS; i++) {
-			receptors[i].transform(deltaTime, currentFrame, view, projection);
+		{
+			PROFILE_ZONE("Render receptors");
+			for (int i = 0; i < RECEPTORS; i++) {
+				receptors[i].draw(snapshot.receptorColors[i], view, projection);
+			}
 		}
 
-		// Source
-		//source.transform(deltaTime, currentFrame, view, projection);
-		source2.transform(deltaTime, currentFrame, view, projection);
-
-		for (int i = 0; i < MAX_PARTICLES; i++) {
-			// Particles
-			//source.particles[i].transform(deltaTime, currentFrame, view, projection);
-			source2.particles[i].transform(deltaTime, currentFrame, view, projection);
-
-			// Collisions
-			//room.handleParticleCollision(source.particles[i]);
-			room.handleParticleCollision(source2.particles[i]);
-
-			// Receptor Collision
-			for (int j = 0; j < RECEPTORS; j++) {
-				receptors[j].handleParticleCollision(source2.particles[i], currentFrame, particlesState);
+		// Sources and particles
+		{
+			PROFILE_ZONE("Render particles");
+			for (size_t s = 0; s < sources.size(); s++) {
+				sources[s].transform(deltaTime, currentFrame, view, projection);
 			}
+			Particle::drawInstances(snapshot.particles, currentFrame, view, projection);
 		}
 
+		CounterSnapshot counters = Counters::read();
+		if (counters.time - lastCounters.time >= 0.5) {
+			double dt = counters.time - lastCounters.time;
+			char status[512];
+			int length = snprintf(status, sizeof(status), "%s - %.2f s simulados/s (%d pasos/frame), t = %.2f s, %.0f pasos/s, %.0f reflexiones/s, %.0f llegadas/s, %lld rayos emitidos", title.c_str(),
+				simulation.speed.load(), simulation.substeps.load(), snapshot.time,
+				(counters.values[STEPS] - lastCounters.values[STEPS]) / dt, (counters.values[REFLECTIONS] - lastCounters.values[REFLECTIONS]) / dt,
+				(counters.values[RECEPTOR_HITS] - lastCounters.values[RECEPTOR_HITS]) / dt, counters.values[RAYS_EMITTED]);
+			if (!transfer.applied.load() && length > 0 && length < (int)sizeof(status)) {
+				length += snprintf(status + length, sizeof(status) - length, " - matriz de energia aproximada (completa al %.0f%%)", 100 * transfer.progress());
+			}
+			long long dropped = hitWriter.dropped();
+			if (dropped > 0 && length > 0 && length < (int)sizeof(status)) {
+				snprintf(status + length, sizeof(status) - length, " - %lld llegadas descartadas", dropped);
+			}
+			glfwSetWindowTitle(window, status);
+			lastCounters = counters;
+		}
 
+#ifdef ENABLE_PROFILING
+		// F9 writes the zones recorded so far without stopping the simulation
+		static bool dumpKey = false;
+		bool dumpPressed = glfwGetKey(window, GLFW_KEY_F9) == GLFW_PRESS;
+		if (dumpPressed && !dumpKey) {
+			std::cout << "Exportando zonas a csv/trace.json" << std::endl;
+			PROFILE_DUMP("csv/trace.json");
+		}
+		dumpKey = dumpPressed;
+#endif
 
+		PROFILE_ZONE("Swap buffers");
 		glfwSwapBuffers(window);
 		glfwPollEvents();
 	}
 
-	glDeleteVertexArrays(n, VAO);
-	glDeleteBuffers(n, VBO);
+	simulation.stop();
+	hitWriter.stop();
+	roomMesh.destroy();
 
 	Source::deleteSourceBuffers();
 	Particle::deleteParticleBuffers();
 	Receptor::deleteReceptorBuffers();
+	ShaderCache::clear();
 
 	glfwTerminate();
 	return 0;
@@ -0,0 +1,32 @@
+#ifndef MATERIAL_H
+#define MATERIAL_H
+
+#include <string>
+
+#include "bands.h"
+
+/**
+ * @class Material
+ * @brief Propiedades acústicas de una superficie.
+ */
+class Material {
+public:
+	std::string name;	/* Nombre del material */
+	Bands absorption;	/* Coeficiente de absorción por banda de octava */
+	float scattering;	/* Coeficiente de dispersión: probabilidad de una reflexión difusa (Lambert) */
+
+	/**
+	 * @brief Constructor por defecto: superficie rígida y especular.
+	 */
+	Material() : name("default"), absorption(0.0f), scattering(0) {}
+
+	/**
+	 * @brief Constructor de la clase Material.
+	 * @param n Nombre del material
+	 * @param a Coeficiente de absorción por banda
+	 * @param s Coeficiente de dispersión
+	 */
+	Material(const std::string& n, const Bands& a, float s) : name(n), absorption(a), scattering(s) {}
+};
+
+#endif // MATERIAL_H
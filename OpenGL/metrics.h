@@ -0,0 +1,192 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "bands.h"
+#include "histogram.h"
+#include "parallel.h"
+#include "profiler.h"
+
+/**
+ * @class Metrics
+ * @brief Parámetros acústicos de cada receptor y banda calculados a partir de sus histogramas energía-tiempo.
+ * @details Los tiempos se miden desde el primer intervalo con energía del receptor (sonido directo). Los tiempos de
+ * reverberación se obtienen de la integral inversa de Schroeder ajustando una recta por mínimos cuadrados:
+ * EDT entre 0 y -10 dB, T20 entre -5 y -25 dB y T30 entre -5 y -35 dB, extrapolados a 60 dB. Si la curva no llega al
+ * final del rango, el valor es NaN. Las bandas de un intervalo son contiguas en el histograma, así que todos los
+ * bucles internos recorren las NUM_BANDS bandas a la vez.
+ */
+class Metrics {
+public:
+	enum { EDT, T20, T30, C50, C80, D50, TS, COUNT };
+
+	int numReceptors;				/* Número de receptores */
+	std::vector<double> values;		/* Parámetros de cada receptor y banda: [receptor][banda][parámetro] */
+
+	/**
+	 * @brief Calcula los parámetros de todos los receptores, repartidos entre varios hilos.
+	 * @param histograms Histogramas de los receptores
+	 * @param threads Número de hilos
+	 */
+	Metrics(const std::vector<Histogram>& histograms, int threads = 1) {
+		numReceptors = (int)histograms.size();
+		values.assign((size_t)numReceptors * NUM_BANDS * COUNT, 0.0);
+		parallelFor(numReceptors, threads, [&](int r, int) {
+			PROFILE_ZONE("Metrics::compute");
+			compute(histograms[r], &values[(size_t)r * NUM_BANDS * COUNT]);
+		});
+	}
+
+	/**
+	 * @brief Devuelve un parámetro de un receptor y una banda.
+	 * @param receptor Índice del receptor
+	 * @param band Índice de la banda
+	 * @param metric Parámetro (EDT, T20, T30, C50, C80, D50 o TS)
+	 */
+	double at(int receptor, int band, int metric) const {
+		return values[((size_t)receptor * NUM_BANDS + band) * COUNT + metric];
+	}
+
+	/**
+	 * @brief Devuelve la media de un parámetro en una banda sobre los receptores en los que es finito.
+	 * @param band Índice de la banda
+	 * @param metric Parámetro
+	 */
+	double mean(int band, int metric) const {
+		double sum = 0;
+		int count = 0;
+		for (int r = 0; r < numReceptors; r++) {
+			double v = at(r, band, metric);
+			if (std::isfinite(v)) {
+				sum += v;
+				count++;
+			}
+		}
+		return count > 0 ? sum / count : std::numeric_limits<double>::quiet_NaN();
+	}
+
+	/**
+	 * @brief Calcula los parámetros de un histograma.
+	 * @param h Histograma del receptor
+	 * @param out Resultado: NUM_BANDS × COUNT valores
+	 */
+	static void compute(const Histogram& h, double* out) {
+		const double nan = std::numeric_limits<double>::quiet_NaN();
+		const int B = NUM_BANDS;
+		for (int i = 0; i < B * COUNT; i++) {
+			out[i] = nan;
+		}
+
+		// Sonido directo: primer intervalo con energía en alguna banda
+		int onset = 0;
+		while (onset < h.numBins) {
+			double sum = 0;
+			for (int b = 0; b < B; b++) sum += h.at(onset, b);
+			if (sum > 0) break;
+			onset++;
+		}
+		if (onset == h.numBins) {
+			return;
+		}
+
+		// Integral inversa de Schroeder y centro de gravedad
+		int bins = h.numBins - onset;
+		const double* e = &h.energy[(size_t)onset * B];
+		std::vector<double> tail((size_t)(bins + 1) * B, 0.0);
+		double moment[B] = {};
+		for (int i = bins - 1; i >= 0; i--) {
+			double t = (i + 0.5) * h.binWidth;
+			for (int b = 0; b < B; b++) {
+				tail[(size_t)i * B + b] = tail[(size_t)(i + 1) * B + b] + e[(size_t)i * B + b];
+				moment[b] += t * e[(size_t)i * B + b];
+			}
+		}
+		const double* total = &tail[0];
+
+		// Claridad y definición a partir de la energía antes de 50 y 80 ms; la claridad no está definida si toda la
+		// energía llega antes o después del límite
+		const int k50 = std::min(bins, (int)(0.050 / h.binWidth + 0.5));
+		const int k80 = std::min(bins, (int)(0.080 / h.binWidth + 0.5));
+		for (int b = 0; b < B; b++) {
+			if (total[b] <= 0) continue;
+			double late50 = tail[(size_t)k50 * B + b], late80 = tail[(size_t)k80 * B + b];
+			double early50 = total[b] - late50, early80 = total[b] - late80;
+			out[b * COUNT + C50] = late50 > 0 && early50 > 0 ? 10 * log10(early50 / late50) : nan;
+			out[b * COUNT + C80] = late80 > 0 && early80 > 0 ? 10 * log10(early80 / late80) : nan;
+			out[b * COUNT + D50] = (total[b] - late50) / total[b];
+			out[b * COUNT + TS] = moment[b] / total[b];
+		}
+
+		// Ajustes por mínimos cuadrados del nivel de decaimiento en cada rango
+		const double top[3] = { 0, -5, -5 };
+		const double bottom[3] = { -10, -25, -35 };
+		double n[3][B] = {}, st[3][B] = {}, sy[3][B] = {}, stt[3][B] = {}, sty[3][B] = {};
+		double lowest[B];
+		for (int b = 0; b < B; b++) lowest[b] = 0;
+
+		for (int i = 0; i < bins; i++) {
+			double t = i * h.binWidth;
+			bool any = false;
+			for (int b = 0; b < B; b++) {
+				double level = tail[(size_t)i * B + b];
+				if (level <= 0 || total[b] <= 0) continue;
+				double y = 10 * log10(level / total[b]);
+				lowest[b] = y;
+				for (int f = 0; f < 3; f++) {
+					if (y <= top[f] && y >= bottom[f]) {
+						n[f][b] += 1;
+						st[f][b] += t;
+						sy[f][b] += y;
+						stt[f][b] += t * t;
+						sty[f][b] += t * y;
+					}
+				}
+				any = any || y >= bottom[2];
+			}
+			if (!any) break;
+		}
+
+		for (int f = 0; f < 3; f++) {
+			for (int b = 0; b < B; b++) {
+				double den = n[f][b] * stt[f][b] - st[f][b] * st[f][b];
+				if (lowest[b] > bottom[f] || n[f][b] < 2 || den <= 0) continue;
+				double slope = (n[f][b] * sty[f][b] - st[f][b] * sy[f][b]) / den;
+				if (slope < 0) {
+					out[b * COUNT + EDT + f] = -60.0 / slope;
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Guarda los parámetros en un archivo CSV con cabecera, una fila por receptor y banda.
+	 * @param filename Nombre del archivo
+	 */
+	void exportCSV(const char* filename) const {
+		FILE* file;
+		if (fopen_s(&file, filename, "w") != 0) {
+			perror("Error al abrir el archivo");
+			return;
+		}
+
+		fprintf(file, "receptor,band,EDT,T20,T30,C50,C80,D50,Ts\n");
+		for (int r = 0; r < numReceptors; r++) {
+			for (int b = 0; b < NUM_BANDS; b++) {
+				fprintf(file, "%d,%d", r, (int)BAND_FREQUENCIES[b]);
+				for (int m = 0; m < COUNT; m++) {
+					fprintf(file, ",%.6f", at(r, b, m));
+				}
+				fprintf(file, "\n");
+			}
+		}
+
+		fclose(file);
+	}
+};
+
+#endif // METRICS_H
@@ -0,0 +1,48 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Devuelve el número de hilos a usar cuando no se especifica ninguno.
+ */
+inline int defaultThreads() {
+	unsigned int n = std::thread::hardware_concurrency();
+	return n > 0 ? (int)n : 1;
+}
+
+/**
+ * @brief Ejecuta una tarea por cada índice en [0, count) repartiendo los índices entre varios hilos.
+ * @details Los hilos toman índices de un contador atómico, así que las tareas de distinta duración se equilibran solas.
+ * La tarea recibe el índice y el número del hilo que la ejecuta, para que pueda usar datos propios de ese hilo.
+ * @param count Número de tareas
+ * @param threads Número de hilos
+ * @param task Tarea: `void(int index, int worker)`
+ */
+template <typename Task>
+void parallelFor(int count, int threads, Task task) {
+	threads = threads < 1 ? 1 : (threads > count ? count : threads);
+	if (threads <= 1) {
+		for (int i = 0; i < count; i++) {
+			task(i, 0);
+		}
+		return;
+	}
+
+	std::atomic<int> next(0);
+	std::vector<std::thread> workers;
+	for (int w = 0; w < threads; w++) {
+		workers.push_back(std::thread([&next, &task, count, w]() {
+			for (int i = next++; i < count; i = next++) {
+				task(i, w);
+			}
+		}));
+	}
+	for (size_t w = 0; w < workers.size(); w++) {
+		workers[w].join();
+	}
+}
+
+#endif // PARALLEL_H
@@ -1,16 +1,23 @@
 #ifndef PARTICLE_H
 #define PARTICLE_H
 
+#include <cstddef>
 #include <ostream>
+#include <vector>
 
 #include "point.h"
 #include "vect.h"
 #include "receptor.h"
+#include "bands.h"
+#include "shaderCache.h"
 
 unsigned int cubeVAO; /* Vertex Array Object */
 unsigned int cubeVBO; /* Vertex Buffer Object */
+unsigned int particleInstanceVBO; /* Buffer con los datos de cada instancia */
+size_t particleInstanceCapacity; /* Instancias que caben en particleInstanceVBO */
+Shader particleShader; /* Shader de las partículas; se obtiene una vez en initParticleBuffers */
 
-/* Vertices del poliedro que forma la particula */
+/* Vertices del poliedro que forma la paráticula */
 float cubeVertices[] = {
 	-0.5f, -0.5f, -0.5f,
 	 0.5f, -0.5f, -0.5f,
@@ -56,28 +63,45 @@ float cubeVertices[] = {
 };
 
 /**
- * @brief Clase que representa una partcula
+ * @brief Datos de una partícula para el dibujo instanciado.
+ * @details Rotación y escala se calculan en el vertex shader a partir de la energía: el ángulo de giro es el tiempo
+ * por la energía y la escala es 0.02 * energía / 5 (0.02 si la partícula no se escala), como en la antigua matriz de
+ * modelo de Particle::transform.
+ */
+struct ParticleInstance {
+	float x, y, z;			/* Posición */
+	float energy;			/* Energía (velocidad de giro y escala) */
+	float r, g, b, a;		/* Color */
+	float scaled;			/* 1 si el tamaño depende de la energía, 0 si no */
+};
+
+/**
+ * @brief Clase que representa una partícula
  */
 class Particle {
 private:
-	Shader shader; /* Shader para dibujar la partcula */
-	bool allowScale; /* Indica si se puede escalar la partcula */
-	glm::vec4 particleColor; /* Color de la partcula */
+	bool allowScale; /* Indica si se puede escalar la partícula */
+	glm::vec4 particleColor; /* Color de la partícula */
 public:
-	Point position;		/* Posicin de la partcula */
-	Vect incidence;		/* Vector de incidencia de la partcula */
-	float energy;		/* Energa de la partcula */
-	float loss;			/* Prdida de energa de la partcula */
-	int size;			/* Tamao del poliedro que forma la partcula */
-	std::string name;	/* Nombre de la partcula */
-	int lastReceptor; /* ltimo receptor con el que ha colisionado la partcula */
-	int lastTriangle; /* ltimo tringulo con el que ha colisionado la partcula */
+	Point position;		/* Posición de la partícula */
+	Vec3 incidence;		/* Vector de incidencia de la partícula */
+	float energy;		/* Energía de la partícula (media de las bandas) */
+	Bands bands;		/* Energía de la partícula por banda de octava */
+	float loss;			/* Pérdida de energía de la partícula */
+	int size;			/* Tamaño del poliedro que forma la partícula */
+	std::string name;	/* Nombre de la partícula */
+	int lastReceptor; /* Último receptor con el que ha colisionado la partícula */
+	int lastTriangle; /* Último triángulo con el que ha colisionado la partícula */
+	float energyFloor; /* Umbral de energía por debajo del cual se aplica la ruleta rusa */
+	bool alive;		/* Indica si la partícula sigue activa */
 
 
 	/**
-	 * @brief Inicializa los buffers de la partcula
+	 * @brief Inicializa los buffers y el shader de la partícula
 	*/
 	static void initParticleBuffers() {
+		particleShader = ShaderCache::get("shaders/particle.vs", "shaders/particle.fs");
+
 		glGenVertexArrays(1, &cubeVAO);
 		glGenBuffers(1, &cubeVBO);
 		glBindVertexArray(cubeVAO);
@@ -85,60 +109,114 @@ public:
 		glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), &cubeVertices, GL_STATIC_DRAW);
 		glEnableVertexAttribArray(0);
 		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+
+		// Atributos por instancia: posición y energía, color e indicador de escala
+		glGenBuffers(1, &particleInstanceVBO);
+		glBindBuffer(GL_ARRAY_BUFFER, particleInstanceVBO);
+		particleInstanceCapacity = 0;
+		GLsizei stride = sizeof(ParticleInstance);
 		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)(3 * sizeof(float)));
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(ParticleInstance, x));
+		glVertexAttribDivisor(1, 1);
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(ParticleInstance, r));
+		glVertexAttribDivisor(2, 1);
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(ParticleInstance, scaled));
+		glVertexAttribDivisor(3, 1);
+
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
 	/**
-	 * @brief Elimina los buffers de la partcula
+	 * @brief Elimina los buffers de la partícula
 	*/
 	static void deleteParticleBuffers() {
 		glDeleteVertexArrays(1, &cubeVAO);
 		glDeleteBuffers(1, &cubeVBO);
+		glDeleteBuffers(1, &particleInstanceVBO);
+	}
+
+	/**
+	 * @brief Dibuja todas las partículas con una sola llamada instanciada.
+	 * @details El buffer de instancias se redimensiona al doble cuando no caben; en cada frame se huérfana con
+	 * glBufferData(NULL) para que el controlador no espere a que termine el frame anterior.
+	 * @param instances Datos de cada partícula
+	 * @param currentFrame Tiempo actual
+	 * @param view Matriz de vista
+	 * @param projection Matriz de proyección
+	 */
+	static void drawInstances(const std::vector<ParticleInstance>& instances, float currentFrame, glm::mat4 view, glm::mat4 projection) {
+		if (instances.empty()) {
+			return;
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, particleInstanceVBO);
+		if (instances.size() > particleInstanceCapacity) {
+			particleInstanceCapacity = particleInstanceCapacity ? particleInstanceCapacity : 1024;
+			while (particleInstanceCapacity < instances.size()) {
+				particleInstanceCapacity *= 2;
+			}
+		}
+		glBufferData(GL_ARRAY_BUFFER, particleInstanceCapacity * sizeof(ParticleInstance), NULL, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(ParticleInstance), instances.data());
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		particleShader.use();
+		particleShader.setFloat("time", currentFrame);
+		particleShader.setMat4("view", view);
+		particleShader.setMat4("projection", projection);
+
+		glBindVertexArray(cubeVAO);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, sizeof(cubeVertices) / (3 * sizeof(float)), (GLsizei)instances.size());
+		glBindVertexArray(0);
 	}
 
 	/**
 	 * Constructor de la clase Particle
-	 * @param v Vector de incidencia de la partcula
-	 * @param e Energa de la partcula
-	 * @param l Prdida de energa de la partcula
-	 * @param p Posicin de la partcula
-	 * @param i Vector de incidencia de la partcula
+	 * @param v Vector de incidencia de la partícula
+	 * @param e Energía de la partícula
+	 * @param l Pérdida de energía de la partícula
+	 * @param p Posición de la partícula
+	 * @param i Vector de incidencia de la partícula
 	 */
-	Particle(double e, double l, Point p, Vect i) {
+	Particle(double e, double l, Point p, Vec3 i) {
 		energy = e;
+		bands = Bands((float)e);
 		loss = l;
 		position = p;
 		incidence = i;
 		size = 36;
 		allowScale = false;
 		name = "Particle";
-		shader = Shader("shaders/cube.vs", "shaders/cube.fs");
 		particleColor = glm::vec4(246.0f / 255.0f, 48.0f / 255.0f, 0.0f, 0.0f);
 
 		lastTriangle = -1;
 		lastReceptor = -1;
+		energyFloor = 0;
+		alive = true;
 	}
 
 	/**
-	 * @brief Permite escalar la partcula
-	 * @param b Indica si se puede escalar la partcula
+	 * @brief Permite escalar la partícula
+	 * @param b Indica si se puede escalar la partícula
 	 */
 	void setAllowScale(bool b) {
 		allowScale = b;
 	}
 
 	/**
-	 * @brief Establece el color de la partcula
-	 * @param c Color de la partcula
+	 * @brief Establece el color de la partícula
+	 * @param c Color de la partícula
 	 */
 	void setParticleColor(glm::vec4 c) {
 		particleColor = c;
 	}
 
 	/**
-	 * @brief Establece el nombre de la partcula
-	 * @param n Nombre de la partcula
+	 * @brief Establece el nombre de la partícula
+	 * @param n Nombre de la partícula
 	 */
 	void setName(std::string n) {
 		name = n;
@@ -154,40 +232,34 @@ public:
 	}
 
 	/**
-	 * @brief Dibuja la partcula
-	 * @param deltaTime Tiempo transcurrido desde el ltimo frame
-	 * @param currentFrame Tiempo actual
-	 * @param view Matriz de vista
-	 * @param projection Matriz de proyeccin
+	 * @brief Avanza la partícula según su incidencia
+	 * @param deltaTime Tiempo transcurrido desde el último frame
 	 */
-	void transform(float deltaTime, float currentFrame, glm::mat4 view, glm::mat4 projection) {
-		shader.use();
-		shader.setVec4("color", particleColor);
-
-		glm::mat4 particleTransform = glm::mat4(1.0f);
-		position = position + incidence.asPoint() * deltaTime * energy * 2;
-
-		particleTransform = glm::translate(particleTransform, glm::vec3(position.x, position.y, position.z));
-		particleTransform = glm::scale(particleTransform, glm::vec3(0.02f) * (allowScale ? energy / 5.0f : 1));
-		particleTransform = glm::rotate(particleTransform, currentFrame * energy, glm::vec3(0.0f, 0.0f, 1.0f));
-		particleTransform = glm::rotate(particleTransform, currentFrame * energy, glm::vec3(1.0f, 0.0f, 0.0f));
-		particleTransform = glm::rotate(particleTransform, currentFrame * energy, glm::vec3(0.0f, 1.0f, 0.0f));
-
-
-		shader.setMat4("model", particleTransform);
-		shader.setMat4("view", view);
-		shader.setMat4("projection", projection);
+	void move(float deltaTime) {
+		position = incidence.along(position, deltaTime * energy * 2);
+	}
 
-		glBindVertexArray(cubeVAO);
-		//glActiveTexture(GL_TEXTURE0);
-		glDrawArrays(GL_TRIANGLES, 0, size);
-		glBindVertexArray(0);
+	/**
+	 * @brief Datos de la partícula para Particle::drawInstances
+	 */
+	ParticleInstance instance() const {
+		ParticleInstance p;
+		p.x = (float)position.x;
+		p.y = (float)position.y;
+		p.z = (float)position.z;
+		p.energy = energy;
+		p.r = particleColor.r;
+		p.g = particleColor.g;
+		p.b = particleColor.b;
+		p.a = particleColor.a;
+		p.scaled = allowScale ? 1.0f : 0.0f;
+		return p;
 	}
 
 	/**
-	 * @brief Sobrecarga del operador de insercin en flujo de salida.
+	 * @brief Sobrecarga del operador de inserción en flujo de salida.
 	 * @param os Flujo de salida.
-	 * @param p Partcula a imprimir.
+	 * @param p Partícula a imprimir.
 	 * @return Referencia al flujo de salida.
 	 */
 	friend std::ostream& operator<<(std::ostream& os, const Particle& p) {
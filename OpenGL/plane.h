@@ -6,6 +6,7 @@
 
 #include "point.h"
 #include "triangle.h"
+#include "vec3.h"
 
 /**
  * @brief Clase plano que contiene un arreglo de puntos y un arreglo de triangulos
@@ -16,6 +17,8 @@ public:
 	int numPoints;						/* Numero de puntos del plano */
 	std::vector<Triangle> triangles;	/* Triangulos del plano */
 	std::string name;					/* Nombre del plano */
+	int trianglesPerSide;				/* Número de celdas por lado de la malla de triángulos */
+	Vec3 normal;						/* Normal unitaria del plano, calculada al construirlo */
 
 	/**
 	 * @brief Constructor por defecto
@@ -23,6 +26,7 @@ public:
 	Plane() {
 		points = NULL;
 		numPoints = 0;
+		trianglesPerSide = 0;
 		name = "none";
 	}
 
@@ -35,17 +39,19 @@ public:
 	Plane(const Point* p, int n, int nt, std::string planeName) {
 		numPoints = n;
 		points = new Point[n];
+		trianglesPerSide = 0;
 		name = planeName;
 		for (int i = 0; i < n; i++) {
 			points[i] = p[i];
 		}
+		normal = Vec3::between(points[1], points[0]).cross(Vec3::between(points[1], points[3])).unit();
 		genTriangles(nt);
 	}
 
 	/**
-	 * @brief Obtiene el posible nmero de tringulos que un plano puede tener en base al nmero de tringulos por cara especificado.
-	 * @param n Nmero de tringulos por cara
-	 * @return Nmero de tringulos que el plano puede tener
+	 * @brief Obtiene el posible número de triángulos que un plano puede tener en base al número de triángulos por cara especificado.
+	 * @param n Número de triángulos por cara
+	 * @return Número de triángulos que el plano puede tener
 	 */
 	int possibleTps(int n) {
 		int tps = 1;
@@ -56,14 +62,14 @@ public:
 	}
 
 	/**
-	 * @brief Genera los tringulos del plano
-	 * @param nt Nmero de tringulos por cara
+	 * @brief Genera los triángulos del plano
+	 * @param nt Número de triángulos por cara
 	 */
 	void genTriangles(int nt) {
 		if (nt <= 0 || nt % 2 != 0)
 			return;
 
-		int trianglesPerSide = possibleTps(nt);
+		trianglesPerSide = possibleTps(nt);
 
 		Point p = points[3] - points[0];
 		double deltaX = p.x / trianglesPerSide;
@@ -116,8 +122,43 @@ public:
 	}
 
 	/**
-	 * @brief Devuelve el nmero de tringulos que tiene el plano
-	 * @return Nmero de tringulos que tiene el plano
+	 * @brief Devuelve el índice del triángulo del plano que contiene un punto, sin recorrer todos los triángulos.
+	 * @param p Punto sobre el plano
+	 * @return Índice del triángulo en `triangles`, o -1 si el plano no tiene triángulos
+	 */
+	int triangleIndexAt(const Point& p) const {
+		if (trianglesPerSide == 0) {
+			return -1;
+		}
+
+		// Coordenadas del punto en la malla, según los ejes que recorre genTriangles
+		Point d = points[3] - points[0];
+		Point q = p - points[0];
+		double fi, fj;
+		if (points[0].z == points[3].z) {
+			fi = q.x / d.x * trianglesPerSide;
+			fj = q.y / d.y * trianglesPerSide;
+		}
+		else if (points[0].y == points[3].y) {
+			fi = q.x / d.x * trianglesPerSide;
+			fj = q.z / d.z * trianglesPerSide;
+		}
+		else {
+			fi = q.y / d.y * trianglesPerSide;
+			fj = q.z / d.z * trianglesPerSide;
+		}
+
+		int i = (int)fi;
+		int j = (int)fj;
+		i = i < 0 ? 0 : (i >= trianglesPerSide ? trianglesPerSide - 1 : i);
+		j = j < 0 ? 0 : (j >= trianglesPerSide ? trianglesPerSide - 1 : j);
+		int second = (fi - i) + (fj - j) > 1 ? 1 : 0;
+		return (i * trianglesPerSide + j) * 2 + second;
+	}
+
+	/**
+	 * @brief Devuelve el número de triángulos que tiene el plano
+	 * @return Número de triángulos que tiene el plano
 	 */
 	int numTriangles() {
 		return triangles.size();
@@ -127,10 +168,8 @@ public:
 	 * @brief Devuelve vector normal del plano
 	 * @return Vector normal del plano
 	 */
-	Vect getNormal() {
-		Vect u = { points[1], points[0] };
-		Vect v = { points[1], points[3] };
-		return (u ^ v).unit();
+	Vec3 getNormal() const {
+		return normal;
 	}
 
 	/**
@@ -138,23 +177,19 @@ public:
 	 * @param v Vector a reflejar
 	 * @return Vector reflejo de v respecto al plano
 	 */
-	Vect reflect(const Vect& v) {
-		Vect n = getNormal();
-		return v - n * (2 * (v * n));
+	Vec3 reflect(const Vec3& v) const {
+		return v.reflect(normal);
 	}
 
 	/**
-	 * @brief Devuelve el punto de incidencia de una partcula con el plano
-	 * @param p Punto de origen de la partcula
-	 * @param i Vector director de la partcula
-	 * @return Punto de incidencia la partcula con el plano
+	 * @brief Devuelve el punto de incidencia de una partícula con el plano
+	 * @param p Punto de origen de la partícula
+	 * @param i Vector director de la partícula
+	 * @return Punto de incidencia la partícula con el plano
 	 */
-	Point incidence(const Point& p, const Vect& i) {
-		Vect n = getNormal();
-		Vect u = { p, points[0] };
-		double dist = u * n / (i * n);
-		Point pi = p + i.asPoint() * dist;
-		return pi;
+	Point incidence(const Point& p, const Vec3& i) const {
+		double dist = Vec3::between(p, points[0]).dot(normal) / i.dot(normal);
+		return i.along(p, dist);
 	}
 
 	/**
@@ -162,9 +197,8 @@ public:
 	 * @param p Punto a comprobar
 	 * @return true si el punto ha superado el plano, false en caso contrario
 	 */
-	bool hasSurpassed(const Point& p) {
-		Vect u = { points[0], p };
-		return u * getNormal() < 0;
+	bool hasSurpassed(const Point& p) const {
+		return distance(p) < 0;
 	}
 
 	/**
@@ -172,9 +206,8 @@ public:
 	 * @param p Punto a comprobar
 	 * @return Distancia de p al plano
 	 */
-	double distance(const Point& p) {
-		Vect u = { points[0], p };
-		return u * getNormal();
+	double distance(const Point& p) const {
+		return Vec3::between(points[0], p).dot(normal);
 	}
 };
 
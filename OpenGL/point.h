@@ -6,6 +6,7 @@
 /**
  * @class Point
  * @brief Representa un punto en un espacio tridimensional.
+ * @details Se copia con las operaciones implícitas, así que es trivialmente copiable.
  */
 class Point {
 public:
@@ -16,7 +17,7 @@ public:
 	/**
 	 * @brief Constructor por defecto. Inicializa las coordenadas en (0, 0, 0).
 	 */
-	Point() : x(0), y(0), z(0) {}
+	constexpr Point() : x(0), y(0), z(0) {}
 
 	/**
 	 * @brief Constructor que inicializa las coordenadas del punto.
@@ -24,20 +25,14 @@ public:
 	 * @param yy Coordenada y.
 	 * @param zz Coordenada z.
 	 */
-	Point(double xx, double yy, double zz) : x(xx), y(yy), z(zz) {}
-
-	/**
-	 * @brief Constructor de copia.
-	 * @param p Punto a copiar.
-	 */
-	Point(const Point& p) : x(p.x), y(p.y), z(p.z) {}
+	constexpr Point(double xx, double yy, double zz) : x(xx), y(yy), z(zz) {}
 
 	/**
 	 * @brief Sobrecarga del operador de igualdad.
 	 * @param p Punto a comparar.
 	 * @return `true` si los puntos son iguales, `false` en caso contrario.
 	 */
-	bool operator==(const Point& p) const {
+	constexpr bool operator==(const Point& p) const {
 		return x == p.x && y == p.y && z == p.z;
 	}
 
@@ -46,60 +41,48 @@ public:
 	 * @param p Punto a comparar.
 	 * @return `true` si los puntos son diferentes, `false` en caso contrario.
 	 */
-	bool operator!=(const Point& p) const {
+	constexpr bool operator!=(const Point& p) const {
 		return !(*this == p);
 	}
 
-	/**
-	 * @brief Sobrecarga del operador de asignacin.
-	 * @param p Punto desde el cual se asignarn las coordenadas.
-	 * @return Referencia al punto actual.
-	 */
-	Point& operator=(const Point& p) {
-		x = p.x;
-		y = p.y;
-		z = p.z;
-		return *this;
-	}
-
 	/**
 	 * @brief Sobrecarga del operador de suma.
-	 * @param p Punto que se sumar.
+	 * @param p Punto que se sumará.
 	 * @return Nuevo punto resultado de la suma.
 	 */
-	Point operator+(const Point& p) const {
+	constexpr Point operator+(const Point& p) const {
 		return Point(x + p.x, y + p.y, z + p.z);
 	}
 
 	/**
 	 * @brief Sobrecarga del operador de resta.
-	 * @param p Punto que se restar.
+	 * @param p Punto que se restará.
 	 * @return Nuevo punto resultado de la resta.
 	 */
-	Point operator-(const Point& p) const {
+	constexpr Point operator-(const Point& p) const {
 		return Point(x - p.x, y - p.y, z - p.z);
 	}
 
 	/**
-	 * @brief Sobrecarga del operador unario de negacin.
+	 * @brief Sobrecarga del operador unario de negación.
 	 * @return Nuevo punto con las coordenadas negadas.
 	 */
-	Point operator-() const {
+	constexpr Point operator-() const {
 		return Point(-x, -y, -z);
 	}
 
 	/**
-	 * @brief Sobrecarga del operador de multiplicacin por un escalar.
-	 * @param f Escalar por el cual se multiplicarn las coordenadas.
+	 * @brief Sobrecarga del operador de multiplicación por un escalar.
+	 * @param f Escalar por el cual se multiplicarán las coordenadas.
 	 * @return Nuevo punto con las coordenadas multiplicadas por el escalar.
 	 */
-	Point operator*(double f) const {
+	constexpr Point operator*(double f) const {
 		return Point(x * f, y * f, z * f);
 	}
 
 	/**
-	 * @brief Sobrecarga del operador de divisin por un escalar.
-	 * @param f Escalar por el cual se dividirn las coordenadas.
+	 * @brief Sobrecarga del operador de división por un escalar.
+	 * @param f Escalar por el cual se dividirán las coordenadas.
 	 * @return Nuevo punto con las coordenadas divididas por el escalar.
 	 */
 	Point operator/(double f) const {
@@ -108,7 +91,7 @@ public:
 	}
 
 	/**
-	 * @brief Sobrecarga del operador de insercin en flujo de salida.
+	 * @brief Sobrecarga del operador de inserción en flujo de salida.
 	 * @param os Flujo de salida.
 	 * @param p Punto a imprimir.
 	 * @return Referencia al flujo de salida.
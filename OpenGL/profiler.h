@@ -0,0 +1,182 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/*
+ * Instrumentación por zonas. Con ENABLE_PROFILING definido, PROFILE_ZONE("nombre") mide el tiempo hasta el final
+ * del bloque en que aparece y PROFILE_DUMP("archivo.json") guarda todas las zonas registradas hasta ese momento en
+ * formato Chrome trace (se puede abrir en Perfetto o en chrome://tracing). Al terminar el programa se guardan en
+ * Profiler::output. Sin ENABLE_PROFILING las macros no generan código.
+ *
+ * Los nombres de las zonas deben ser cadenas literales: solo se guarda el puntero.
+ */
+#ifdef ENABLE_PROFILING
+
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Zona medida: nombre e instantes de inicio y fin en nanosegundos desde el arranque del perfilador.
+ */
+struct ProfileEvent {
+	const char* name;
+	long long start;
+	long long end;
+};
+
+/**
+ * @class ProfileBuffer
+ * @brief Registro de zonas de un hilo.
+ * @details Solo escribe el hilo propietario, así que no hay bloqueos: los eventos se guardan en bloques de tamaño fijo
+ * enlazados y el contador de cada bloque se publica con orden release. Un volcado concurrente lee con acquire el
+ * prefijo ya publicado de cada bloque. Los bloques no se liberan nunca, por lo que los punteros siguen siendo
+ * válidos aunque el hilo haya terminado.
+ */
+class ProfileBuffer {
+public:
+	static const int CHUNK = 4096;	/* Eventos por bloque */
+
+	struct Chunk {
+		ProfileEvent events[CHUNK];
+		std::atomic<int> count;
+		std::atomic<Chunk*> next;
+		Chunk() : count(0), next(nullptr) {}
+	};
+
+	int thread;		/* Número del hilo en el orden en que se registró */
+	Chunk* head;	/* Primer bloque */
+	Chunk* tail;	/* Bloque en que escribe el hilo */
+
+	explicit ProfileBuffer(int t) : thread(t) {
+		head = tail = new Chunk();
+	}
+
+	/**
+	 * @brief Añade una zona al registro.
+	 */
+	void record(const char* name, long long start, long long end) {
+		int c = tail->count.load(std::memory_order_relaxed);
+		if (c == CHUNK) {
+			Chunk* next = new Chunk();
+			tail->next.store(next, std::memory_order_release);
+			tail = next;
+			c = 0;
+		}
+		ProfileEvent& e = tail->events[c];
+		e.name = name;
+		e.start = start;
+		e.end = end;
+		tail->count.store(c + 1, std::memory_order_release);
+	}
+};
+
+/**
+ * @class Profiler
+ * @brief Registro global de los buffers de todos los hilos y exportación a Chrome trace.
+ */
+class Profiler {
+public:
+	std::chrono::steady_clock::time_point epoch;	/* Origen de los tiempos */
+	std::mutex mutex;								/* Protege la lista de buffers (solo al registrar hilos y al volcar) */
+	std::vector<ProfileBuffer*> buffers;			/* Buffer de cada hilo */
+	const char* output;								/* Archivo que se escribe al terminar el programa */
+
+	/**
+	 * @brief Devuelve el perfilador global.
+	 */
+	static Profiler& instance() {
+		// No se destruye nunca, para que siga disponible en el volcado de atexit
+		static Profiler* profiler = new Profiler();
+		return *profiler;
+	}
+
+	/**
+	 * @brief Devuelve el buffer del hilo actual, registrándolo la primera vez.
+	 */
+	static ProfileBuffer& local() {
+		thread_local ProfileBuffer* buffer = nullptr;
+		if (!buffer) {
+			Profiler& p = instance();
+			std::lock_guard<std::mutex> lock(p.mutex);
+			buffer = new ProfileBuffer((int)p.buffers.size());
+			p.buffers.push_back(buffer);
+		}
+		return *buffer;
+	}
+
+	/**
+	 * @brief Nanosegundos desde el arranque del perfilador.
+	 */
+	static long long now() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - instance().epoch).count();
+	}
+
+	/**
+	 * @brief Guarda todas las zonas registradas en formato Chrome trace (JSON).
+	 * @param filename Nombre del archivo
+	 */
+	void dump(const char* filename) {
+		FILE* file;
+		if (fopen_s(&file, filename, "w") != 0) {
+			perror("Error al abrir el archivo");
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		fprintf(file, "{\"traceEvents\":[\n");
+		bool first = true;
+		for (size_t t = 0; t < buffers.size(); t++) {
+			fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}", first ? "" : ",\n", buffers[t]->thread, buffers[t]->thread);
+			first = false;
+			for (ProfileBuffer::Chunk* c = buffers[t]->head; c; c = c->next.load(std::memory_order_acquire)) {
+				int count = c->count.load(std::memory_order_acquire);
+				for (int i = 0; i < count; i++) {
+					const ProfileEvent& e = c->events[i];
+					fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", e.name, buffers[t]->thread, e.start / 1000.0, (e.end - e.start) / 1000.0);
+				}
+			}
+		}
+		fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+		fclose(file);
+	}
+
+private:
+	Profiler() : epoch(std::chrono::steady_clock::now()), output("trace.json") {
+		std::atexit([]() { instance().dump(instance().output); });
+	}
+};
+
+/**
+ * @class ProfileZone
+ * @brief Mide el tiempo de vida del objeto y lo registra en el buffer del hilo.
+ */
+class ProfileZone {
+public:
+	const char* name;
+	long long start;
+
+	explicit ProfileZone(const char* n) : name(n), start(Profiler::now()) {}
+
+	~ProfileZone() {
+		Profiler::local().record(name, start, Profiler::now());
+	}
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_DUMP(filename) Profiler::instance().dump(filename)
+#define PROFILE_OUTPUT(filename) (Profiler::instance().output = (filename))
+
+#else
+
+#define PROFILE_ZONE(name)
+#define PROFILE_DUMP(filename)
+#define PROFILE_OUTPUT(filename)
+
+#endif // ENABLE_PROFILING
+
+#endif // PROFILER_H
@@ -0,0 +1,95 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @class Random
+ * @brief Generador de números pseudoaleatorios SplitMix64.
+ * @details Todo el estado cabe en un entero de 64 bits, por lo que es trivial de sembrar, copiar y guardar.
+ * @note https://prng.di.unimi.it/splitmix64.c
+ */
+class Random {
+public:
+	uint64_t state; /* Estado interno del generador */
+
+	/**
+	 * @brief Constructor de la clase Random.
+	 * @param seed Semilla del generador
+	 */
+	Random(uint64_t seed = 0x853c49e6748fea9bULL) : state(seed) {}
+
+	/**
+	 * @brief Crea un generador independiente para un flujo dado a partir de una semilla común.
+	 * @param seed Semilla común
+	 * @param stream Índice del flujo (por ejemplo, el índice del bloque de rayos)
+	 * @return Generador del flujo
+	 */
+	static Random forStream(uint64_t seed, uint64_t stream) {
+		Random r(seed ^ (stream * 0xd1342543de82ef95ULL));
+		r.nextU64();
+		return r;
+	}
+
+	/**
+	 * @brief Devuelve el siguiente entero de 64 bits.
+	 */
+	uint64_t nextU64() {
+		uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		return z ^ (z >> 31);
+	}
+
+	/**
+	 * @brief Devuelve un número real uniforme en [0, 1).
+	 */
+	double nextDouble() {
+		return (nextU64() >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+	/**
+	 * @brief Devuelve una dirección unitaria uniformemente distribuida sobre la esfera.
+	 * @param x Componente x de la dirección
+	 * @param y Componente y de la dirección
+	 * @param z Componente z de la dirección
+	 */
+	void nextDirection(double& x, double& y, double& z) {
+		double cz = 1.0 - 2.0 * nextDouble();
+		double phi = 2.0 * 3.14159265358979323846 * nextDouble();
+		double r = sqrt(1.0 - cz * cz);
+		x = r * cos(phi);
+		y = r * sin(phi);
+		z = cz;
+	}
+
+	/**
+	 * @brief Devuelve una dirección con distribución de Lambert (coseno) alrededor de una normal unitaria.
+	 * @param nx Componente x de la normal
+	 * @param ny Componente y de la normal
+	 * @param nz Componente z de la normal
+	 * @param x Componente x de la dirección
+	 * @param y Componente y de la dirección
+	 * @param z Componente z de la dirección
+	 *
+	 * @note La base ortonormal se construye sin ramas: https://jcgt.org/published/0006/01/01/
+	 */
+	void nextLambert(double nx, double ny, double nz, double& x, double& y, double& z) {
+		double sign = nz >= 0 ? 1.0 : -1.0;
+		double a = -1.0 / (sign + nz);
+		double b = nx * ny * a;
+		double tx = 1.0 + sign * nx * nx * a, ty = sign * b, tz = -sign * nx;
+		double bx = b, by = sign + ny * ny * a, bz = -ny;
+
+		double u = nextDouble();
+		double phi = 2.0 * 3.14159265358979323846 * nextDouble();
+		double r = sqrt(u);
+		double ct = r * cos(phi), st = r * sin(phi), cn = sqrt(1.0 - u);
+		x = tx * ct + bx * st + nx * cn;
+		y = ty * ct + by * st + ny * cn;
+		z = tz * ct + bz * st + nz * cn;
+	}
+};
+
+#endif // RANDOM_H
@@ -2,21 +2,24 @@
 #define RECEPTOR_H
 
 #include <ostream>
+#include <string>
 
 #include "point.h"
 #include "triangle.h"
 #include "source.h"
 #include "particle.h"
+#include "counters.h"
+#include "shaderCache.h"
+#include "hitLog.h"
 
 const glm::vec4 DEFAULT_RECEPTOR_COLOR = glm::vec4(0.32, 0.8, 0.37, 1); /* Color por defecto del receptor */
-const int MAX_RECEPTOR_DATA = 10000;
 
 unsigned int receptorVAO; /* Vertex Array Object */
 unsigned int receptorVBO; /* Vertex Buffer Object */
 
 /**
  * @class Receptor
- * @brief Clase que representa un receptor de partculas
+ * @brief Clase que representa un receptor de partículas
  */
 class Receptor {
 private:
@@ -25,7 +28,7 @@ private:
 
 
 	/**
-	 * @brief Genera los tringulos que forman el receptor en base a los vrtices del icosaedro.
+	 * @brief Genera los triángulos que forman el receptor en base a los vértices del icosaedro.
 	 */
 	void genTriangles() {
 		int j = 0;
@@ -42,19 +45,16 @@ private:
 		}
 	}
 public:
-	int size;			/* Nmero de caras del receptor */
+	int size;			/* Número de caras del receptor */
 	int ID;	/* Nombre del receptor */
 	float scale;		/* Escala del receptor */
-	Point position;		/* Posicin del receptor */
+	Point position;		/* Posición del receptor */
 	double radio;		/* Radio del receptor */
-	double energy; /* Energa del receptor */
+	double energy; /* Energía del receptor */
 	double* energyRoom;
-	double** data; /* Datos del receptor */
-	int idx = 0; /* ndice de los datos del receptor */
-	bool saved; /* Indica si el receptor ha sido guardado */
-	float lt;
+	HitRing* hits; /* Cola de llegadas que vacía un HitWriter; nullptr si no se registran */
 
-	std::vector<Triangle> triangles; /* Tringulos que forman el receptor */
+	std::vector<Triangle> triangles; /* Triángulos que forman el receptor */
 
 	/**
 	 * @brief Elimina los buffers del recptor.
@@ -79,26 +79,23 @@ public:
 		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)(3 * sizeof(float)));
 	}
 
-	Receptor() {}
+	Receptor() : hits(nullptr) {}
 
 	/**
 	 * @brief Constructor de la clase Receptor.
-	 * @param p Posicin del receptor
+	 * @param p Posición del receptor
 	 * @param s Escala del receptor
 	 */
 	Receptor(Point p, float s) {
 		size = 20 * 3;
-		saved = false;
 		ID = -1;
-		shader = Shader("shaders/cube.vs", "shaders/cube.fs");
+		shader = ShaderCache::get("shaders/cube.vs", "shaders/cube.fs");
 		receptorColor = DEFAULT_RECEPTOR_COLOR;
 		scale = s;
 		position = p + (errorTranslation * scale);
 		radio = computeRadio();
 		genTriangles();
-		data = new double* [MAX_RECEPTOR_DATA];
-		idx = 0;
-		lt = 0;
+		hits = nullptr;
 	}
 
 	Receptor& operator=(const Receptor& r) {
@@ -112,10 +109,7 @@ public:
 		triangles = r.triangles;
 		energy = r.energy;
 		energyRoom = r.energyRoom;
-		data = r.data;
-		idx = r.idx;
-		saved = r.saved;
-		lt = r.lt;
+		hits = r.hits;
 		return *this;
 	}
 
@@ -138,14 +132,38 @@ public:
 		triangles = r.triangles;
 		energy = r.energy;
 		energyRoom = r.energyRoom;
-		data = r.data;
-		idx = r.idx;
-		saved = r.saved;
-		lt = r.lt;
+		hits = r.hits;
 	}
 
 	double computeRadio() {
-		return 0.21 * sqrt(3) * (3 + sqrt(5)) * scale / 12;
+		return radioFor(scale);
+	}
+
+	/**
+	 * @brief Devuelve el radio de la esfera circunscrita de un receptor de una escala dada.
+	 * @param s Escala del receptor
+	 */
+	static double radioFor(float s) {
+		return 0.21 * sqrt(3) * (3 + sqrt(5)) * s / 12;
+	}
+
+	/**
+	 * @brief Genera las posiciones de una malla cúbica de receptores.
+	 * @param count Número de receptores: 3, 9, 27, 81, 243, 729, 2187
+	 * @return Posiciones de los receptores (sin la corrección de traslación)
+	 */
+	static std::vector<Point> grid(int count) {
+		std::vector<Point> points;
+		int receptorsPerSide = pow(count, 1.0f / 3.0f);
+		float receptorDelta = (2 * 1) / (receptorsPerSide - static_cast<float>(1));
+		for (float i = 0; i < receptorsPerSide; i += 1) {
+			for (float j = 0; j < receptorsPerSide; j += 1) {
+				for (float k = 0; k < receptorsPerSide; k += 1) {
+					points.push_back({ -1 + i * receptorDelta, -1 + j * (receptorDelta), -1 + k * receptorDelta });
+				}
+			}
+		}
+		return points;
 	}
 
 	/**
@@ -155,6 +173,13 @@ public:
 		receptorColor = color;
 	}
 
+	/**
+	 * @brief Devuelve el color del receptor
+	 */
+	glm::vec4 getReceptorColor() const {
+		return receptorColor;
+	}
+
 
 	void setEnergyRoom(double* energyRoom) {
 		this->energyRoom = energyRoom;
@@ -172,11 +197,21 @@ public:
 	 * @param deltaTime Tiempo entre frames
 	 * @param currentFrame Tiempo actual
 	 * @param view Matriz de vista
-	 * @param projection Matriz de proyeccin
+	 * @param projection Matriz de proyección
 	 */
 	void transform(float deltaTime, float currentFrame, glm::mat4 view, glm::mat4 projection) {
+		draw(receptorColor, view, projection);
+	}
+
+	/**
+	 * @brief Renderiza el receptor con un color dado, sin leer su estado de simulación.
+	 * @param color Color del receptor
+	 * @param view Matriz de vista
+	 * @param projection Matriz de proyección
+	 */
+	void draw(glm::vec4 color, glm::mat4 view, glm::mat4 projection) {
 		shader.use();
-		shader.setVec4("color", receptorColor);
+		shader.setVec4("color", color);
 
 		glm::mat4 sourceTransform = glm::mat4(1.0f);
 
@@ -190,7 +225,7 @@ public:
 		glBindVertexArray(receptorVAO);
 		glDrawArrays(GL_TRIANGLES, 0, size);
 
-		shader.setVec4("color", receptorColor - glm::vec4(0.3));
+		shader.setVec4("color", color - glm::vec4(0.3));
 		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 		glDrawArrays(GL_TRIANGLES, 0, size);
 		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
@@ -199,48 +234,45 @@ public:
 
 	}
 
-	void handleParticleCollision(Particle& p, float currentTime, bool paused) {
-		Vect dist = Vect(p.position, position);
+	/**
+	 * @brief Registra la llegada de una partícula si está dentro del receptor.
+	 * @param p Partícula
+	 * @param currentTime Segundos simulados
+	 * @param record Indica si la llegada se añade a la cola `hits` (si la hay)
+	 */
+	void handleParticleCollision(Particle& p, float currentTime, bool record) {
 		if (p.lastTriangle == -1) {
 			return;
 		}
 
-		double particleEnergy = 0;
-		double roomEnergy = 0;
-		if (dist.length() < radio && p.lastReceptor == -1) {
+		if (Vec3::between(p.position, position).lengthSquared() < radio * radio && p.lastReceptor == -1) {
 			energy = p.energy + energyRoom[p.lastTriangle];
 			p.setLastReceptor(ID);
+			Counters::add(RECEPTOR_HITS);
 			receptorColor = receptorColor + p.energy * glm::vec4(0.05);
-		}
-
-		if (lt == 0) {
-			lt = currentTime;
-		}
 
-		if (!saved) {
-			if (lt == currentTime) {
-				return;
-			}
-			else {
-				lt = currentTime;
-			}
-
-			if (paused && idx < MAX_RECEPTOR_DATA) {
-				data[idx] = new double[4];
-				data[idx][0] = currentTime;
-				data[idx][1] = energy;
-				idx++;
-			}
-			else if (idx >= MAX_RECEPTOR_DATA) {
-				saved = true;
-				char* filename = new char[100];
-				snprintf(filename, 100, "csv/receptors/receptor_%f_%f_%f.csv", position.x, position.y, position.z);
-				CSV(filename, data, MAX_RECEPTOR_DATA, 2);
-				std::cout << "Receptor " << ID << " saved" << std::endl;
+			if (record && hits) {
+				HitRecord r;
+				r.time = currentTime;
+				r.energy = (float)energy;
+				r.triangle = p.lastTriangle;
+				r.dx = (float)p.incidence.x;
+				r.dy = (float)p.incidence.y;
+				r.dz = (float)p.incidence.z;
+				hits->push(r);
 			}
 		}
 	}
 
+	/**
+	 * @brief Nombre del archivo CSV de las llegadas del receptor.
+	 */
+	std::string hitsFilename() const {
+		char filename[128];
+		snprintf(filename, sizeof(filename), "csv/receptors/receptor_%f_%f_%f.csv", position.x, position.y, position.z);
+		return filename;
+	}
+
 	friend std::ostream& operator<<(std::ostream& os, const Receptor& r) {
 		os << r.position << " " << r.scale << " " << r.ID;
 		return os;
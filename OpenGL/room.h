@@ -1,36 +1,65 @@
 #ifndef ROOM_H
 #define ROOM_H
 
+#include <atomic>
 #include <ostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
 
 #include "plane.h"
 #include "csv.h"
+#include "exportQueue.h"
 #include "receptor.h"
 #include "particle.h"
+#include "random.h"
+#include "material.h"
+#include "profiler.h"
+#include "counters.h"
 
 constexpr auto V_SON = 340.0f; /* Constante de la velocidad del sonido en el aire */
 
+/**
+ * @brief Cálculo de las matrices de transferencia de energía al crear una habitación.
+ */
+enum TransferMode {
+	TRANSFER_FULL,			/* Matrices completas (energyTrans) */
+	TRANSFER_APPROXIMATE,	/* Matriz aproximada; la completa se calcula aparte (TransferJob) */
+	TRANSFER_NONE			/* Sin matrices ni exportación: solo geometría y materiales (trazado sin ventana) */
+};
+
 /*
- * @brief Clase que representa una habitacin
- * @details Una habitacin est formada por un conjunto de planos que la delimitan
+ * @brief Clase que representa una habitación
+ * @details Una habitación está formada por un conjunto de planos que la delimitan
  */
 class Room {
 public:
-	Plane* planes;		/* Planos que delimitan la habitacin */
-	int numPlanes;		/* Nmero de planos que delimitan la habitacin */
-	int numTriangles;	/* Nmero de tringulos que forman los planos */
-	int numReceptors;	/* Nmero de receptores de la habitacin */
-	Receptor* receptors; /* Receptores de la habitacin */
-	double** energyRoom; /* Matriz de porcentajes de energa */
-	double** energyReceptors; /* Matriz de energa en los receptores */
+	Plane* planes;		/* Planos que delimitan la habitación */
+	int numPlanes;		/* Número de planos que delimitan la habitación */
+	int numTriangles;	/* Número de triángulos que forman los planos */
+	int numReceptors;	/* Número de receptores de la habitación */
+	Receptor* receptors; /* Receptores de la habitación */
+	double** energyRoom; /* Matriz de porcentajes de energía */
+	double** energyReceptors; /* Matriz de energía en los receptores */
+	double** planeTransfer; /* Filas aproximadas de cada plano mientras se calcula la matriz completa (nullptr si no hay) */
+	Random rng;			/* Generador de la ruleta rusa y de la dispersión de las partículas */
+	std::vector<Material> materials;	/* Tabla de materiales; el índice 0 es el material por defecto */
+	std::vector<int> triangleMaterials;	/* Índice del material de cada triángulo (índice global) */
+	std::vector<float> triangleEnergy;	/* Energía acumulada que colorea cada triángulo (índice global) */
+	std::vector<int> dirtyBegin;		/* Primer triángulo con energía sin dibujar de cada plano (índice global) */
+	std::vector<int> dirtyEnd;			/* Uno más que el último triángulo con energía sin dibujar de cada plano */
 
 
 	/**
 	 * @brief Constructor de la clase Room
-	 * @param nt Nmero de tringulos que forman los planos
-	 * @param np Nmero de planos que delimitan la habitacin
+	 * @param nt Número de triángulos que forman los planos
+	 * @param np Número de planos que delimitan la habitación
+	 * @param nr Número de receptores
+	 * @param rs Receptores
+	 * @param transfer Cálculo de las matrices de energía
 	 */
-	Room(int nt, int np, int nr, Receptor* rs) {
+	Room(int nt, int np, int nr, Receptor* rs, TransferMode transfer = TRANSFER_FULL) {
+		PROFILE_ZONE("Room::Room");
 		numTriangles = nt;
 		numPlanes = np;
 		numReceptors = nr;
@@ -47,11 +76,42 @@ public:
 			break;
 		}
 
-		energyTrans();
+		materials.push_back(Material());
+		triangleMaterials.assign(numTriangles * numPlanes, 0);
+		triangleEnergy.assign(numTriangles * numPlanes, 0.0f);
+		dirtyBegin.resize(numPlanes);
+		dirtyEnd.resize(numPlanes);
+		for (int q = 0; q < numPlanes; q++) {
+			dirtyBegin[q] = q * numTriangles;
+			dirtyEnd[q] = (q + 1) * numTriangles;
+		}
+		planeTransfer = nullptr;
+
+		switch (transfer) {
+		case TRANSFER_FULL:
+			energyTrans();
+			break;
+		case TRANSFER_APPROXIMATE: {
+			std::vector<Triangle> triangles = indexTriangles();
+			approximateTrans(triangles);
+			receptorTrans(triangles);
+			break;
+		}
+		case TRANSFER_NONE:
+			// El trazado sin ventana no usa las matrices de energía
+			indexTriangles();
+			for (int i = 0; i < numTriangles * numPlanes; i++) {
+				energyRoom[i] = nullptr;
+			}
+			for (int i = 0; i < numReceptors; i++) {
+				energyReceptors[i] = nullptr;
+			}
+			break;
+		}
 	}
 
 	/**
-	 * @brief Genera una habitacin en forma de cubo
+	 * @brief Genera una habitación en forma de cubo
 	 */
 	void genCube() {
 		Point* floorPoints = new Point[4]{ {-2, -2, 2}, {-2, -2, -2}, {2, -2, 2} ,{2, -2, -2} };
@@ -81,7 +141,73 @@ public:
 	}
 
 	/**
-	 * @brief Devuelve los vectores normales de todos los planos que constituyen la habitacin
+	 * @brief Añade un material a la tabla de materiales.
+	 * @param m Material
+	 * @return Índice del material en la tabla
+	 */
+	int addMaterial(const Material& m) {
+		materials.push_back(m);
+		return materials.size() - 1;
+	}
+
+	/**
+	 * @brief Asigna un material a todos los triángulos de un plano.
+	 * @param plane Índice del plano
+	 * @param material Índice del material
+	 */
+	void setPlaneMaterial(int plane, int material) {
+		for (int j = 0; j < numTriangles; j++) {
+			triangleMaterials[plane * numTriangles + j] = material;
+		}
+	}
+
+	/**
+	 * @brief Devuelve el material de un triángulo.
+	 * @param plane Índice del plano
+	 * @param triangle Índice del triángulo dentro del plano
+	 */
+	const Material& materialAt(int plane, int triangle) const {
+		return materials[triangleMaterials[plane * numTriangles + triangle]];
+	}
+
+	/**
+	 * @brief Carga materiales desde un archivo CSV y los asigna a los planos.
+	 * @details Cada línea tiene la forma `plano,a63,a125,a250,a500,a1000,a2000,a4000,a8000,dispersión`, donde
+	 * `plano` es el nombre del plano (floor, ceiling, leftWall, rightWall, frontWall, backWall).
+	 * @param filename Nombre del archivo CSV
+	 */
+	void loadMaterials(const char* filename) {
+		std::ifstream file(filename);
+		if (!file.is_open()) {
+			std::cout << "Error al abrir el archivo de materiales " << filename << std::endl;
+			return;
+		}
+
+		std::string line;
+		while (std::getline(file, line)) {
+			std::stringstream ss(line);
+			std::string name, cell;
+			std::getline(ss, name, ',');
+
+			float values[NUM_BANDS + 1];
+			int count = 0;
+			while (count < NUM_BANDS + 1 && std::getline(ss, cell, ',')) {
+				values[count++] = (float)atof(cell.c_str());
+			}
+			if (count < NUM_BANDS + 1) {
+				continue;
+			}
+
+			for (int i = 0; i < numPlanes; i++) {
+				if (planes[i].name == name) {
+					setPlaneMaterial(i, addMaterial(Material(name, Bands(values), values[NUM_BANDS])));
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Devuelve los vectores normales de todos los planos que constituyen la habitación
 	 * @return Array de vectores normales
 	 */
 	Vect* getNormals() {
@@ -93,7 +219,7 @@ public:
 	}
 
 	/**
-	 * @brief Devuelve los puntos de todos los planos que constituyen la habitacin
+	 * @brief Devuelve los puntos de todos los planos que constituyen la habitación
 	 * @return Array de puntos
 	 */
 	double** getAllVertices() {
@@ -117,7 +243,7 @@ public:
 
 
 	/**
-	 * @brief Devuelve el puntero del plano candidato a ser el primero en ser alcanzado por una partcula
+	 * @brief Devuelve el puntero del plano candidato a ser el primero en ser alcanzado por una partícula
 	 * @return Array de planos
 	 */
 	Plane* SurpassedPlane(const Point& p) {
@@ -130,8 +256,8 @@ public:
 	}
 
 	/**
-	 * @brief Controla las colisiones de una partcula con los planos de la habitacin en base al mtodo de reflexiones.
-	 * @param p Puntero a la partcula
+	 * @brief Controla las colisiones de una partícula con los planos de la habitación en base al método de reflexiones.
+	 * @param p Puntero a la partícula
 	 */
 	void handleParticleCollision(Particle& p) {
 		int index = nearestSurpassedPlaneIndex(p.position, p.incidence);
@@ -139,11 +265,12 @@ public:
 		if (index != -1) {
 			Plane* nearestSurpassed = &planes[index];
 			Triangle* nearestTriangle = nullptr;
-			double dist = 1000000;
+			double dist = 1000000.0 * 1000000.0;
 			int minIndex = 0;
 
+			// Se comparan cuadrados de distancias para no calcular raíces
 			for (int i = 0; i < numTriangles; i++) {
-				double d = Vect(nearestSurpassed->triangles[i].getBarycenter(), p.position).length();
+				double d = Vec3::between(nearestSurpassed->triangles[i].getBarycenter(), p.position).lengthSquared();
 				if (d < dist) {
 					dist = d;
 					nearestTriangle = &nearestSurpassed->triangles[i];
@@ -151,33 +278,61 @@ public:
 				}
 			}
 
-			int k = 0;
-			for (int i = 0; i < numPlanes; i++) {
-				for (int j = 0; j < numTriangles; j++) {
-					glm::vec4 colorTransform = glm::vec4(p.energy * p.loss, -p.energy * p.loss, -p.energy * p.loss, 0) * 0.5f;
-					colorTransform = colorTransform * (float)energyRoom[index * numTriangles + minIndex][k];
-					planes[i].triangles[j].setColor(planes[i].triangles[j].getColor() + colorTransform);
-					k++;
+			// La energía transferida a cada triángulo se acumula para colorearlo; solo cambian los que la reciben, y el
+			// rango modificado se guarda por plano para no subir los planos que no han recibido nada
+			const double* transfer = energyRoom[index * numTriangles + minIndex];
+			float e = p.energy * p.loss * 0.5f;
+			for (int q = 0; q < numPlanes; q++) {
+				int first = q * numTriangles, last = first + numTriangles;
+				for (int k = first; k < last; k++) {
+					if (transfer[k] != 0) {
+						triangleEnergy[k] += e * (float)transfer[k];
+						dirtyBegin[q] = k < dirtyBegin[q] ? k : dirtyBegin[q];
+						dirtyEnd[q] = k + 1 > dirtyEnd[q] ? k + 1 : dirtyEnd[q];
+					}
 				}
 			}
 
 			p.setLastReceptor(-1);
 			p.setLastTriangle(nearestTriangle->getIndex());
 
-			Vect normal = nearestSurpassed->getNormal();
-			Vect reflex = nearestSurpassed->reflect(p.incidence);
+			const Material& material = materialAt(index, minIndex);
+			const Vec3& normal = nearestSurpassed->normal;
+			Vec3 reflex = p.incidence.reflect(normal);
 			Point pi = nearestSurpassed->incidence(p.position, p.incidence);
+
+			// Con probabilidad igual al coeficiente de dispersión la reflexión es difusa
+			if (rng.nextDouble() < material.scattering) {
+				rng.nextLambert(normal.x, normal.y, normal.z, reflex.x, reflex.y, reflex.z);
+			}
+
 			p.position = pi;
 			p.incidence = reflex;
-			p.energy -= p.energy * p.loss;
+			p.bands *= material.absorption.complement() * (1.0f - p.loss);
+			p.energy = p.bands.mean();
+			Counters::add(REFLECTIONS);
+
+			// Ruleta rusa: la partícula sobrevive con probabilidad energía / umbral. Como en Tracer se usa la banda más
+			// energética, para no terminar partículas que aún aportan en alguna banda
+			float peak = p.bands.peak();
+			if (peak < p.energyFloor) {
+				if (rng.nextDouble() * p.energyFloor >= peak) {
+					p.alive = false;
+					Counters::add(RAYS_TERMINATED);
+				}
+				else {
+					p.bands *= Bands(p.energyFloor / peak);
+					p.energy = p.bands.mean();
+				}
+			}
 		}
 	}
 
 	/**
-	 * @brief [DEPRECATED] Devuelve el puntero del plano ms cercano a una partcula
-	 * @return Puntero al plano ms cercano
+	 * @brief [DEPRECATED] Devuelve el puntero del plano más cercano a una partícula
+	 * @return Puntero al plano más cercano
 	 */
-	Plane* nearestSurpassedPlane(const Point& p, const Vect& incidence) {
+	Plane* nearestSurpassedPlane(const Point& p, const Vec3& incidence) {
 		Plane* nearest = &planes[0];
 
 		if (SurpassedPlane(p) == nullptr) {
@@ -198,10 +353,10 @@ public:
 	}
 
 	/**
-	 * @brief Devuelve el ndice del plano ms cercano a una partcula
-	 * @return ndice al plano ms cercano
+	 * @brief Devuelve el índice del plano más cercano a una partícula
+	 * @return índice al plano más cercano
 	 */
-	int nearestSurpassedPlaneIndex(const Point& p, const Vect& incidence) {
+	int nearestSurpassedPlaneIndex(const Point& p, const Vec3& incidence) {
 		Plane* nearest = &planes[0];
 
 		if (SurpassedPlane(p) == nullptr) {
@@ -224,55 +379,58 @@ public:
 	}
 
 	/**
-	 * @brief Devuelve los colores de los tringulos que constituyen la habitacin.
+	 * @brief Devuelve los colores de los triángulos que constituyen la habitación.
 	 * @return Array de colores
 	 */
 	std::vector<glm::vec4> getTriangleColors() {
 		std::vector<glm::vec4> colors;
+		int k = 0;
 		for (int i = 0; i < numPlanes; i++) {
 			for (int j = 0; j < numTriangles; j++) {
-				colors.push_back(planes[i].triangles[j].getColor());
+				float e = triangleEnergy[k++];
+				colors.push_back(planes[i].triangles[j].getColor() + glm::vec4(e, -e, -e, 0));
 			}
 		}
 		return colors;
 	}
 
 	/**
-	 * @brief Devuelve el ngulo slido entre dos tringulos a una distancia dada.
-	 * @param from Tringulo desde el que se mide el ngulo slido
-	 * @param to Tringulo hasta el que se mide el ngulo slido
-	 * @param distance Distancia entre los tringulos
-	 * @return ngulo slido
+	 * @brief Marca como dibujados todos los triángulos.
+	 */
+	void clearDirty() {
+		for (int q = 0; q < numPlanes; q++) {
+			dirtyBegin[q] = (q + 1) * numTriangles;
+			dirtyEnd[q] = q * numTriangles;
+		}
+	}
+
+	/**
+	 * @brief Devuelve el ángulo sólido entre dos triángulos a una distancia dada.
+	 * @param from Triángulo desde el que se mide el ángulo sólido
+	 * @param to Triángulo hasta el que se mide el ángulo sólido
+	 * @param distance Distancia entre los triángulos
+	 * @return Ángulo sólido
 	 */
 	double solidAngle(Triangle from, Triangle to, double distance) {
 		Point baricenterFrom = from.getBarycenter();
 
-		Vect ABc = Vect(baricenterFrom, to.getA()).unit();
-		Vect BBc = Vect(baricenterFrom, to.getB()).unit();
-		Vect CBc = Vect(baricenterFrom, to.getC()).unit();
-
-		ABc.setStart(baricenterFrom);
-		BBc.setStart(baricenterFrom);
-		CBc.setStart(baricenterFrom);
-
-		Point A = ABc.p2;
-		Point B = BBc.p2;
-		Point C = CBc.p2;
-
-		Triangle temp = Triangle(A, B, C);
-		Vect newNormal = temp.getNormal();
-		newNormal.setStart(baricenterFrom);
+		// Direcciones unitarias hacia los vértices y sus puntos sobre la esfera unidad
+		Vec3 ABc = Vec3::between(baricenterFrom, to.getA()).unit();
+		Vec3 BBc = Vec3::between(baricenterFrom, to.getB()).unit();
+		Vec3 CBc = Vec3::between(baricenterFrom, to.getC()).unit();
 
-		Vect transBarycenter = newNormal * distance;
-		transBarycenter.setStart(baricenterFrom);
+		Point A = baricenterFrom + ABc;
+		Point B = baricenterFrom + BBc;
+		Point C = baricenterFrom + CBc;
 
-		Point newBarycenter = transBarycenter.p2;
+		Vec3 newNormal = Vec3::between(A, B).cross(Vec3::between(A, C)).unit();
+		Point newBarycenter = newNormal.along(baricenterFrom, distance);
 
 		A = intersection(newBarycenter, newNormal, A, ABc);
 		B = intersection(newBarycenter, newNormal, B, BBc);
 		C = intersection(newBarycenter, newNormal, C, CBc);
 
-		return Triangle(A, B, C).area();
+		return Vec3::between(A, B).cross(Vec3::between(A, C)).length() / 2.0;
 	}
 
 
@@ -280,103 +438,174 @@ public:
 	double soildAngle(Triangle from, Receptor to, double distance) {
 		Point baricenterFrom = from.getBarycenter();
 
-		Vect receptorNormal = -from.getNormal();
-		receptorNormal.setStart(to.position);
+		Vec3 normal = from.getNormal();
+		Vec3 receptorNormal = -normal;
 
-		Vect perpendicular = receptorNormal.perpendicular() * to.radio;
-		perpendicular.setStart(to.position);
+		// Punto del borde del receptor en una dirección perpendicular a la normal
+		Vec3 perpendicular = Vec3(-receptorNormal.y, receptorNormal.x, 0);
+		Point planePoint = perpendicular.along(to.position, to.radio);
+		Vec3 lineDir = Vec3::between(baricenterFrom, planePoint).unit();
 
-		Point planePoint = perpendicular.p2;
-		Vect lineDir = Vect(baricenterFrom, planePoint).unit();
-
-		Vect temp = from.getNormal() * distance;
-		temp.setStart(baricenterFrom);
-		Point newCenter = temp.p2;
+		Point newCenter = normal.along(baricenterFrom, distance);
 
 		Point A = intersection(newCenter, receptorNormal, planePoint, lineDir);
-		double radio = Vect(newCenter, A).length();
+		double radio = Vec3::between(newCenter, A).length();
 
 		return 2 * PI * pow(radio, 2);
 	}
 
 
 	/**
-	 * @brief Devuelve el punto de interseccin entre un plano y una recta.
+	 * @brief Devuelve el punto de intersección entre un plano y una recta.
 	 * @param plane Punto del plano
 	 * @param normal Vector normal del plano
 	 * @param line Punto de la recta
-	 * @param direction Vector direccin de la recta
-	 * @return Punto de interseccin
+	 * @param direction Vector dirección de la recta
+	 * @return Punto de intersección
 	 */
-	Point intersection(Point plane, Vect normal, Point line, Vect direction) {
-		Vect vectToPlane = Vect(line, plane);
+	Point intersection(const Point& plane, const Vec3& normal, const Point& line, const Vec3& direction) {
+		Vec3 vectToPlane = Vec3::between(line, plane);
 
-		// OJO: Si el vector direccin es paralelo al plano, no hay interseccin	
-		if (direction * normal == 0) {
+		// OJO: Si el vector dirección es paralelo al plano, no hay intersección	
+		double d = direction.dot(normal);
+		if (d == 0) {
 			return Point(0, 0, 0);
 		}
 
-		double t = (vectToPlane * normal) / (direction * normal);
-		Point intersection = line + direction.asPoint() * t;
-		return intersection;
+		return direction.along(line, vectToPlane.dot(normal) / d);
 	}
 
 	/**
-	 * @brief Clculo de matrices necesarias para el algoritmo de transferencia de energa.
+	 * @brief Cálculo de matrices necesarias para el algoritmo de transferencia de energía.
+	 * @details energyRoom y energyReceptors quedan prestadas a la cola de exportación: no se debe volver a llamar hasta
+	 * que ExportQueue::wait() haya terminado, porque rellenaría los mismos arrays de filas mientras se escriben.
 	 */
 	void energyTrans() {
-		int dim = numPlanes * numTriangles;
-
-		Triangle* triangles = new Triangle[dim];
+		PROFILE_ZONE("Room::energyTrans");
+		std::vector<Triangle> triangles = indexTriangles();
+		transferMatrix(triangles, energyRoom, nullptr);
+		receptorTrans(triangles);
+	}
 
+	/**
+	 * @brief Asigna a cada triángulo su índice global.
+	 * @return Copia de los triángulos en orden de índice
+	 */
+	std::vector<Triangle> indexTriangles() {
+		std::vector<Triangle> triangles(numPlanes * numTriangles);
 		int k = 0;
 		for (int i = 0; i < numPlanes; i++) {
 			for (int j = 0; j < numTriangles; j++) {
-				Triangle temp = planes[i].triangles[j];
-				temp.setIndex(k);
-
-				planes[i].triangles[j] = temp;
-				triangles[k] = temp;
+				planes[i].triangles[j].setIndex(k);
+				triangles[k] = planes[i].triangles[j];
 				k++;
 			}
 		}
+		return triangles;
+	}
 
-		double** distances = new double* [dim];
-		double** time = new double* [dim];
+	/**
+	 * @brief Calcula la matriz de porcentajes de energía entre triángulos y la exporta junto con las distancias y
+	 * los tiempos.
+	 * @details Solo lee la copia de los triángulos, así que puede ejecutarse en otro hilo mientras la habitación se
+	 * usa. Las distancias y los tiempos se ceden a la cola de exportación; la matriz queda prestada, así que sus filas
+	 * no deben liberarse ni modificarse. Sin exportación, las distancias y los tiempos no se calculan.
+	 *
+	 * La cancelación se comprueba antes de cada fila; si se cancela, se liberan todas las filas (también las de
+	 * `matrix`) y no se exporta nada.
+	 * @param triangles Triángulos en orden de índice (indexTriangles)
+	 * @param matrix Array de dim filas que se rellena con filas nuevas
+	 * @param progress Contador de filas calculadas (puede ser nullptr)
+	 * @param writeCSV Indica si se exportan las matrices
+	 * @param cancel Indicador de cancelación (puede ser nullptr)
+	 * @return false si se ha cancelado
+	 */
+	bool transferMatrix(const std::vector<Triangle>& triangles, double** matrix, std::atomic<int>* progress, bool writeCSV = true,
+		const std::atomic<bool>* cancel = nullptr) {
+		PROFILE_ZONE("Room::transferMatrix");
+		int dim = (int)triangles.size();
+		double** distances = writeCSV ? new double* [dim] : nullptr;
+		double** time = writeCSV ? new double* [dim] : nullptr;
 
 		for (int i = 0; i < dim; i++) {
-			distances[i] = new double[dim];
-			time[i] = new double[dim];
-			energyRoom[i] = new double[dim];
-		}
-
-		for (int i = 0; i < numReceptors; i++) {
-			energyReceptors[i] = new double[dim];
+			if (writeCSV) {
+				distances[i] = new double[dim];
+				time[i] = new double[dim];
+			}
+			matrix[i] = new double[dim];
 		}
 
-		// Porcentaje de energa de la habitacin
+		// Porcentaje de energía de la habitación
 		for (int i = 0; i < dim; i++) {
+			if (cancel && cancel->load(std::memory_order_relaxed)) {
+				for (int k = 0; k < dim; k++) {
+					if (writeCSV) {
+						delete[] distances[k];
+						delete[] time[k];
+					}
+					delete[] matrix[k];
+				}
+				delete[] distances;
+				delete[] time;
+				return false;
+			}
+
 			double sumAreas = 0;
 			for (int j = 0; j < dim; j++) {
 				if (triangles[i].getID() == triangles[j].getID()) {
-					distances[i][j] = 0;
-					time[i][j] = 0;
-					energyRoom[i][j] = 0;
+					if (writeCSV) {
+						distances[i][j] = 0;
+						time[i][j] = 0;
+					}
+					matrix[i][j] = 0;
 				}
 				else {
-					distances[i][j] = Vect(triangles[i].getBarycenter(), triangles[j].getBarycenter()).length();
-					time[i][j] = distances[i][j] / V_SON;
-					energyRoom[i][j] = solidAngle(triangles[i], triangles[j], 0.2);
-					sumAreas += energyRoom[i][j];
+					if (writeCSV) {
+						distances[i][j] = Vec3::between(triangles[i].getBarycenter(), triangles[j].getBarycenter()).length();
+						time[i][j] = distances[i][j] / V_SON;
+					}
+					matrix[i][j] = solidAngle(triangles[i], triangles[j], 0.2);
+					sumAreas += matrix[i][j];
 				}
 			}
 
 			for (int j = 0; j < dim; j++) {
-				energyRoom[i][j] /= sumAreas;
+				matrix[i][j] /= sumAreas;
+			}
+			if (progress) {
+				progress->fetch_add(1, std::memory_order_relaxed);
 			}
 		}
+		if (!writeCSV) {
+			return true;
+		}
 
-		// Porcentaje de energa de los receptores
+		// Se guardan las matrices en archivos CSV en segundo plano: las distancias y los tiempos solo se usan para
+		// exportarlos y se ceden a la cola, que los libera; las energías siguen siendo de la habitación
+		ExportQueue& exports = ExportQueue::instance();
+		std::cout << "Encolando distancias para csv/distances.csv" << std::endl;
+		exports.take("csv/distances.csv", distances, dim, dim);
+
+		std::cout << "Encolando tiempos para csv/time.csv" << std::endl;
+		exports.take("csv/time.csv", time, dim, dim);
+
+		std::cout << "Encolando porcentajes de energia para csv/energyRoom.csv" << std::endl;
+		exports.lend("csv/energyRoom.csv", matrix, dim, dim);
+		return true;
+	}
+
+	/**
+	 * @brief Calcula y exporta los porcentajes de energía de los receptores y se los asigna.
+	 * @param triangles Triángulos en orden de índice (indexTriangles)
+	 * @param writeCSV Indica si se exporta la matriz
+	 */
+	void receptorTrans(const std::vector<Triangle>& triangles, bool writeCSV = true) {
+		int dim = (int)triangles.size();
+		for (int i = 0; i < numReceptors; i++) {
+			energyReceptors[i] = new double[dim];
+		}
+
+		// Porcentaje de energía de los receptores
 		for (int i = 0; i < numReceptors; i++) {
 			double sumAreas = 0;
 			for (int j = 0; j < dim; j++) {
@@ -389,27 +618,58 @@ public:
 
 			receptors[i].setEnergyRoom(energyReceptors[i]);
 		}
+		if (!writeCSV) {
+			return;
+		}
 
-		// Se guardan las matrices en archivos CSV
-		std::cout << "Exportando distancias a csv/distances.csv" << std::endl;
-		CSV("csv/distances.csv", distances, dim, dim);
-
-		std::cout << "Exportando tiempos a csv/time.csv" << std::endl;
-		CSV("csv/time.csv", time, dim, dim);
-
-		std::cout << "Exportando porcentajes de energia csv/energyRoom.csv" << std::endl;
-		CSV("csv/energyRoom.csv", energyRoom, dim, dim);
+		std::cout << "Encolando porcentaje de energias de receptores para csv/energyReceptors.csv" << std::endl;
+		ExportQueue::instance().lend("csv/energyReceptors.csv", energyReceptors, numReceptors, dim);
+	}
 
-		std::cout << "Exportando porcentaje de energias de receptores csv/energyReceptors.csv" << std::endl;
-		CSV("csv/energyReceptors.csv", energyReceptors, numReceptors, dim);
+	/**
+	 * @brief Rellena la matriz de energía con una aproximación que cuesta O(dim): cada plano reparte la energía entre
+	 * los triángulos de los demás planos en proporción a su área.
+	 * @details Todas las filas de un plano comparten la misma fila, así que la memoria es numPlanes * dim. Sirve
+	 * mientras se calcula la matriz completa (transferMatrix), que la sustituye con setTransfer.
+	 * @param triangles Triángulos en orden de índice (indexTriangles)
+	 */
+	void approximateTrans(const std::vector<Triangle>& triangles) {
+		int dim = (int)triangles.size();
+		planeTransfer = new double* [numPlanes];
+		for (int p = 0; p < numPlanes; p++) {
+			planeTransfer[p] = new double[dim];
+			double sumAreas = 0;
+			for (int j = 0; j < dim; j++) {
+				planeTransfer[p][j] = j / numTriangles == p ? 0 : triangles[j].area();
+				sumAreas += planeTransfer[p][j];
+			}
+			for (int j = 0; j < dim; j++) {
+				planeTransfer[p][j] /= sumAreas;
+			}
+		}
 
 		for (int i = 0; i < dim; i++) {
-			delete[] distances[i];
-			delete[] time[i];
+			energyRoom[i] = planeTransfer[i / numTriangles];
+		}
+	}
+
+	/**
+	 * @brief Sustituye la matriz de energía aproximada por la completa.
+	 * @details Solo debe llamarla el hilo que mueve las partículas, entre dos pasos.
+	 * @param matrix Matriz completa (transferMatrix); pasa a ser la de la habitación
+	 */
+	void setTransfer(double** matrix) {
+		double** approximate = energyRoom;
+		energyRoom = matrix;
+		delete[] approximate;
+
+		if (planeTransfer) {
+			for (int p = 0; p < numPlanes; p++) {
+				delete[] planeTransfer[p];
+			}
+			delete[] planeTransfer;
+			planeTransfer = nullptr;
 		}
-		delete[] triangles;
-		delete[] distances;
-		delete[] time;
 	}
 
 };
@@ -0,0 +1,142 @@
+#ifndef ROOM_MESH_H
+#define ROOM_MESH_H
+
+#include <vector>
+
+#include "room.h"
+#include "triangle.h"
+#include "shaderCache.h"
+
+/**
+ * @class RoomMesh
+ * @brief Malla única con todos los triángulos de una habitación.
+ * @details Las posiciones se suben una vez en float; la energía de cada triángulo va en un segundo buffer (repetida en
+ * sus tres vértices) y el shader calcula el color a partir de ella. En cada frame solo se sube, plano a plano, el rango
+ * de triángulos que ha cambiado (Room::dirtyBegin y Room::dirtyEnd) y la habitación entera se dibuja con una sola
+ * llamada.
+ */
+class RoomMesh {
+public:
+	unsigned int VAO;			/* Vertex Array Object */
+	unsigned int vertexVBO;		/* Posiciones de los vértices */
+	unsigned int energyVBO;		/* Energía de cada vértice (la de su triángulo) */
+	int triangles;				/* Número de triángulos de la malla */
+	std::vector<float> staging;	/* Memoria reutilizada para subir el rango modificado */
+	Shader shader;				/* Shader para dibujar la habitación */
+
+	RoomMesh() : VAO(0), vertexVBO(0), energyVBO(0), triangles(0) {}
+
+	/**
+	 * @brief Crea los buffers con la geometría de la habitación.
+	 * @param room Habitación
+	 */
+	void init(const Room& room) {
+		triangles = room.numPlanes * room.numTriangles;
+		std::vector<float> vertices;
+		vertices.reserve(triangles * 9);
+		for (int i = 0; i < room.numPlanes; i++) {
+			for (int j = 0; j < room.numTriangles; j++) {
+				const Triangle& t = room.planes[i].triangles[j];
+				Point points[3] = { t.getA(), t.getB(), t.getC() };
+				for (int v = 0; v < 3; v++) {
+					vertices.push_back((float)points[v].x);
+					vertices.push_back((float)points[v].y);
+					vertices.push_back((float)points[v].z);
+				}
+			}
+		}
+
+		glGenVertexArrays(1, &VAO);
+		glGenBuffers(1, &vertexVBO);
+		glGenBuffers(1, &energyVBO);
+		glBindVertexArray(VAO);
+
+		glBindBuffer(GL_ARRAY_BUFFER, vertexVBO);
+		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+
+		glBindBuffer(GL_ARRAY_BUFFER, energyVBO);
+		glBufferData(GL_ARRAY_BUFFER, triangles * 3 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+		glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+		glEnableVertexAttribArray(1);
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindVertexArray(0);
+
+		staging.reserve(triangles * 3);
+		shader = ShaderCache::get("shaders/room.vs", "shaders/room.fs");
+	}
+
+	/**
+	 * @brief Sube la energía de los triángulos modificados desde el último frame.
+	 * @param room Habitación
+	 */
+	void update(Room& room) {
+		update(room.triangleEnergy.data(), room.dirtyBegin, room.dirtyEnd);
+		room.clearDirty();
+	}
+
+	/**
+	 * @brief Sube la energía del rango modificado de cada plano.
+	 * @param energy Energía de todos los triángulos
+	 * @param begin Primer triángulo del rango de cada plano
+	 * @param end Uno más que el último triángulo del rango de cada plano
+	 */
+	void update(const float* energy, const std::vector<int>& begin, const std::vector<int>& end) {
+		for (size_t q = 0; q < begin.size(); q++) {
+			update(energy, begin[q], end[q]);
+		}
+	}
+
+	/**
+	 * @brief Sube la energía de un rango de triángulos.
+	 * @param energy Energía de todos los triángulos
+	 * @param begin Primer triángulo del rango
+	 * @param end Uno más que el último triángulo del rango
+	 */
+	void update(const float* energy, int begin, int end) {
+		if (begin >= end) {
+			return;
+		}
+
+		staging.clear();
+		for (int k = begin; k < end; k++) {
+			staging.push_back(energy[k]);
+			staging.push_back(energy[k]);
+			staging.push_back(energy[k]);
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, energyVBO);
+		glBufferSubData(GL_ARRAY_BUFFER, begin * 3 * sizeof(float), staging.size() * sizeof(float), staging.data());
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	/**
+	 * @brief Dibuja la habitación.
+	 * @param view Matriz de vista
+	 * @param projection Matriz de proyección
+	 */
+	void draw(glm::mat4 view, glm::mat4 projection) {
+		shader.use();
+		shader.setMat4("model", glm::mat4(1.0f));
+		shader.setMat4("view", view);
+		shader.setMat4("projection", projection);
+		shader.setVec4("baseColor", DEFAULT_TRIANGLE_COLOR);
+
+		glBindVertexArray(VAO);
+		glDrawArrays(GL_TRIANGLES, 0, triangles * 3);
+		glBindVertexArray(0);
+	}
+
+	/**
+	 * @brief Elimina los buffers de la malla.
+	 */
+	void destroy() {
+		glDeleteVertexArrays(1, &VAO);
+		glDeleteBuffers(1, &vertexVBO);
+		glDeleteBuffers(1, &energyVBO);
+	}
+};
+
+#endif // ROOM_MESH_H
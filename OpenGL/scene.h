@@ -0,0 +1,249 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <stdio.h>
+#include <vector>
+
+#include "room.h"
+#include "emitter.h"
+#include "histogram.h"
+#include "hybrid.h"
+#include "parallel.h"
+#include "profiler.h"
+
+/**
+ * @class Scene
+ * @brief Varias fuentes en una misma habitación.
+ * @details La geometría, las matrices de la habitación y los datos precalculados de los motores se comparten entre
+ * todas las fuentes. La respuesta de cada fuente se guarda por separado, así que la respuesta de cualquier
+ * combinación de fuentes con ganancias arbitrarias se obtiene por superposición lineal sin volver a trazar.
+ *
+ * En modo recíproco los rayos se emiten desde cada receptor hacia esferas del mismo radio centradas en las fuentes. Por
+ * reciprocidad, la energía esperada es la misma que en el sentido directo, pero cada segmento solo se compara con las
+ * fuentes y los receptores se reparten entre varios hilos. El presupuesto total de rayos se reparte entre los
+ * receptores. El trazado directo recorre las fuentes una tras otra en un solo hilo.
+ */
+class Scene {
+public:
+	Hybrid engine;									/* Motor compartido por todas las fuentes */
+	std::vector<Emitter> sources;					/* Fuentes de la escena */
+	std::vector<std::vector<Histogram>> responses;	/* Histogramas de cada receptor para cada fuente */
+	bool resumed;									/* Indica si la fuente en curso se ha restaurado de un punto de control */
+
+	/**
+	 * @brief Constructor de la clase Scene.
+	 * @param rm Habitación
+	 * @param rs Centros de los receptores
+	 * @param r Radio de los receptores
+	 * @param binWidth Ancho de los intervalos de los histogramas en segundos
+	 * @param maxTime Duración máxima de la respuesta en segundos
+	 * @param c Transición entre la parte temprana y la tardía (inactiva: solo trazado de rayos)
+	 * @param chunkSize Número de rayos por bloque
+	 * @param threshold Umbral relativo de energía de la ruleta rusa y de la poda de imágenes
+	 */
+	Scene(Room& rm, const std::vector<Point>& rs, double r, double binWidth, double maxTime, const Crossover& c, int chunkSize, double threshold)
+		: engine(rm, rs, r, binWidth, maxTime, c, chunkSize, threshold), resumed(false) {}
+
+	/**
+	 * @brief Añade una fuente a la escena.
+	 * @param e Emisor de la fuente
+	 * @return Índice de la fuente
+	 */
+	int addSource(const Emitter& e) {
+		sources.push_back(e);
+		return sources.size() - 1;
+	}
+
+	/**
+	 * @brief Calcula la respuesta de las fuentes que aún no la tienen.
+	 */
+	void run() {
+		for (size_t s = responses.size(); s < sources.size(); s++) {
+			// La fuente restaurada ya tiene calculada la parte temprana y parte de los rayos
+			if (resumed) {
+				resumed = false;
+			}
+			else {
+				engine.begin(sources[s]);
+			}
+			engine.finish(sources[s]);
+			responses.push_back(engine.histograms);
+		}
+	}
+
+	/**
+	 * @brief Guarda el estado del trazado directo: respuestas terminadas, avance de cada fuente y motor.
+	 * @details Se llama desde el punto de control del trazador, con una fuente a medias.
+	 */
+	void save(Checkpoint& c) const {
+		c.put((uint64_t)responses.size());
+		for (size_t s = 0; s < responses.size(); s++) {
+			for (size_t r = 0; r < responses[s].size(); r++) {
+				c.putVector(responses[s][r].energy);
+			}
+		}
+		c.put((uint64_t)sources.size());
+		for (size_t s = 0; s < sources.size(); s++) {
+			sources[s].save(c);
+		}
+		engine.save(c);
+	}
+
+	/**
+	 * @brief Restaura el estado guardado con save; run() continúa desde la fuente en curso. La escena debe tener las
+	 * mismas fuentes y receptores que cuando se guardó.
+	 * @return false si los datos no son válidos; la escena queda entonces inservible
+	 */
+	bool load(Checkpoint& c) {
+		uint64_t done = 0, count = 0;
+		if (!c.get(done) || done >= sources.size()) {
+			c.ok = false;
+			return false;
+		}
+		responses.assign((size_t)done, engine.tracer.histograms);
+		for (size_t s = 0; s < responses.size(); s++) {
+			for (size_t r = 0; r < responses[s].size(); r++) {
+				size_t size = responses[s][r].energy.size();
+				if (c.getVector(responses[s][r].energy) != size) {
+					c.ok = false;
+				}
+			}
+		}
+		if (!c.get(count) || count != sources.size()) {
+			c.ok = false;
+			return false;
+		}
+		for (size_t s = 0; s < sources.size(); s++) {
+			sources[s].load(c);
+		}
+		resumed = engine.load(c);
+		return resumed;
+	}
+
+	/**
+	 * @brief Rayos que emite cada receptor en trazado recíproco.
+	 * @details El presupuesto es el mismo que en sentido directo, la suma de los rayos de las fuentes pendientes, y se
+	 * reparte por igual entre los receptores.
+	 */
+	long long reciprocalRays() const {
+		long long total = 0;
+		for (size_t s = responses.size(); s < sources.size(); s++) {
+			total += sources[s].totalRays;
+		}
+		long long R = (long long)engine.receptors.size();
+		long long rays = R > 0 ? (total + R - 1) / R : total;
+		return rays > 0 ? rays : 1;
+	}
+
+	/**
+	 * @brief Indica si el trazado recíproco es más barato que el directo para esta escena.
+	 * @details Cada reflexión cuesta un test por plano y uno por esfera objetivo, y el número de reflexiones es
+	 * proporcional a los rayos trazados. En sentido directo se trazan en un solo hilo los rayos de cada fuente contra
+	 * los receptores; en sentido recíproco, reciprocalRays() rayos desde cada receptor contra las fuentes, con los
+	 * receptores repartidos entre los hilos. Con el mismo presupuesto de rayos, el recíproco compensa cuando hay más
+	 * receptores que fuentes o más de un hilo.
+	 * @param threads Número de hilos disponibles
+	 */
+	bool preferReciprocal(int threads) const {
+		if (responses.size() >= sources.size()) {
+			return false;
+		}
+		double walls = (double)engine.tracer.walls.size();
+		double R = (double)engine.receptors.size();
+		double S = (double)(sources.size() - responses.size());
+		double workers = threads < R ? threads : R;
+		double forward = 0;
+		for (size_t s = responses.size(); s < sources.size(); s++) {
+			forward += (double)sources[s].totalRays * (walls + R);
+		}
+		double reciprocal = R * (double)reciprocalRays() * (walls + S) / (workers > 1 ? workers : 1);
+		return reciprocal < forward;
+	}
+
+	/**
+	 * @brief Calcula la respuesta de las fuentes que aún no la tienen con trazado recíproco.
+	 * @details Cada receptor emite reciprocalRays() rayos, así que el total es el mismo que en sentido directo. La parte
+	 * temprana de fuentes imagen, si está activa, se sigue calculando en sentido directo porque su coste no depende
+	 * del número de rayos. Todas las fuentes deben compartir la misma pérdida por reflexión.
+	 * @param threads Número de hilos
+	 */
+	void runReciprocal(int threads) {
+		size_t first = responses.size();
+		if (first == sources.size()) {
+			return;
+		}
+
+		long long perReceptor = reciprocalRays();
+		Tracer& base = engine.tracer;
+		base.reset();
+
+		std::vector<Point> targets;
+		for (size_t s = first; s < sources.size(); s++) {
+			targets.push_back(sources[s].position);
+			responses.push_back(base.histograms);
+			if (engine.crossover.active && engine.imageSource.valid) {
+				engine.imageSource.run(sources[s].position, sources[s].energy, sources[s].loss, engine.receptors, engine.radio, responses.back());
+				engine.images += engine.imageSource.images;
+			}
+		}
+
+		// Un trazador por hilo, con las fuentes como esferas objetivo
+		Tracer prototype = Tracer(*engine.room, targets, engine.radio, base.binWidth, base.maxTime, base.batch.capacity, base.threshold);
+		prototype.crossover = base.crossover;
+		prototype.singlePrecision = base.singlePrecision;
+		int workers = threads < (int)engine.receptors.size() ? threads : (int)engine.receptors.size();
+		std::vector<Tracer> tracers(workers > 0 ? workers : 1, prototype);
+		std::vector<long long> rays(tracers.size(), 0);
+
+		const Emitter& reference = sources[first];
+		parallelFor((int)engine.receptors.size(), (int)tracers.size(), [&](int r, int worker) {
+			PROFILE_ZONE("Scene::reciprocalReceptor");
+			Tracer& tracer = tracers[worker];
+			tracer.reset();
+			Emitter emitter = Emitter(engine.receptors[r], perReceptor, 1.0f, reference.loss, Random::forStream(reference.seed, r).nextU64());
+			tracer.run(emitter);
+			rays[worker] += tracer.raysTraced;
+			for (size_t s = 0; s < targets.size(); s++) {
+				responses[first + s][r].accumulate(tracer.histograms[s], sources[first + s].energy);
+			}
+		});
+
+		for (size_t w = 0; w < rays.size(); w++) {
+			engine.rays += rays[w];
+		}
+	}
+
+	/**
+	 * @brief Combina las respuestas de todas las fuentes con una ganancia de energía por fuente.
+	 * @param gains Ganancia de energía de cada fuente; las que faltan valen 1
+	 * @return Histogramas combinados de cada receptor
+	 */
+	std::vector<Histogram> combine(const std::vector<double>& gains) const {
+		std::vector<Histogram> combined = responses[0];
+		for (size_t r = 0; r < combined.size(); r++) {
+			std::vector<double>& dst = combined[r].energy;
+			for (size_t i = 0; i < dst.size(); i++) {
+				double sum = 0;
+				for (size_t s = 0; s < responses.size(); s++) {
+					sum += (s < gains.size() ? gains[s] : 1.0) * responses[s][r].energy[i];
+				}
+				dst[i] = sum;
+			}
+		}
+		return combined;
+	}
+
+	/**
+	 * @brief Exporta la respuesta de cada fuente por banda.
+	 * @param prefix Prefijo de los archivos; se les añade el índice de la fuente y la frecuencia de la banda
+	 */
+	void exportCSV(const char* prefix) const {
+		for (size_t s = 0; s < responses.size(); s++) {
+			char sourcePrefix[256];
+			snprintf(sourcePrefix, sizeof(sourcePrefix), "%s_source%d", prefix, (int)s);
+			Histogram::exportCSV(sourcePrefix, responses[s]);
+		}
+	}
+};
+
+#endif // SCENE_H
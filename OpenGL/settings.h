@@ -0,0 +1,146 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "point.h"
+
+/**
+ * @class Settings
+ * @brief Parámetros de la simulación. Se pueden modificar desde la línea de comandos con `--clave=valor`.
+ */
+class Settings {
+public:
+	int receptors = 27;			/* Número de receptores: 3, 9, 27, 81, 243, 729, 2187 */
+	int n = 242;				/* Triángulos por cara: 2, 8, 18, 32, 50, 2n*n, 800, 1800 */
+	int maxParticles = 800;		/* Partículas de la ventana interactiva. Se recomienda usar 400 para un rendimiento óptimo */
+	double simRate = 240;		/* Pasos por segundo simulado del hilo de simulación de la ventana interactiva */
+	double simBudget = 0;		/* Segundos de cálculo por frame de la simulación interactiva; 0 avanza en tiempo real */
+	float energy = 800;			/* Energía de la fuente */
+	float loss = 0.2f;			/* Pérdida de energía por reflexión */
+	std::vector<Point> sources;	/* Posiciones de las fuentes (`--source=x,y,z`, se puede repetir) */
+	std::vector<double> gains;	/* Ganancia de energía de cada fuente al combinar respuestas (`--gains=g1,g2,...`) */
+
+	bool trace = false;			/* Ejecuta el trazado estocástico sin ventana */
+	bool images = false;		/* Ejecuta el método de fuentes imagen sin ventana */
+	int imageOrder = 10;		/* Orden máximo de reflexión de las fuentes imagen */
+	bool hybrid = false;		/* Ejecuta la respuesta híbrida (fuentes imagen + trazado) sin ventana */
+	double crossover = 0.05;	/* Instante de transición de la respuesta híbrida en segundos */
+	double fade = 0.01;			/* Duración del fundido de la transición en segundos */
+	const char* direction = "auto"; /* Sentido del trazado: forward, reciprocal o auto (el más barato) */
+	const char* precision = "double"; /* Precisión del trazado: double, float o compare (informe de exactitud) */
+	int threads = 0;			/* Hilos de trabajo; 0 usa todos los núcleos */
+	long long rays = 1000000;	/* Número total de rayos del trazado estocástico */
+	int chunk = 65536;			/* Rayos por bloque del trazado estocástico */
+	uint64_t seed = 1;			/* Semilla del trazado estocástico */
+	double maxTime = 2.0;		/* Duración de la respuesta en segundos */
+	double binWidth = 0.001;	/* Ancho de los intervalos de los histogramas en segundos */
+	double threshold = 1e-3;	/* Umbral de energía (relativo a la inicial) para la ruleta rusa; 0 la desactiva */
+	const char* checkpoint = nullptr; /* Archivo del punto de control del trazado sin ventana; nullptr no guarda ninguno */
+	double checkpointInterval = 60;	/* Segundos entre puntos de control */
+	bool resume = false;			/* Continúa el trazado desde el punto de control, si hay uno válido */
+	float scattering = 0;		/* Coeficiente de dispersión del material por defecto */
+	const char* materials = nullptr; /* Archivo CSV de materiales por plano */
+
+	bool sweep = false;			/* Ejecuta un barrido de parámetros sin ventana */
+	std::vector<double> sweepN;			/* Valores de n del barrido (`--sweep-n=a,b,...`); vacío usa n */
+	std::vector<double> sweepLoss;		/* Valores de pérdida del barrido; vacío usa loss */
+	std::vector<double> sweepEnergy;	/* Valores de energía del barrido; vacío usa energy */
+	std::vector<double> sweepRays;		/* Valores de rayos por fuente del barrido; vacío usa rays */
+	const char* sweepOutput = "csv/sweep.csv"; /* Archivo de resultados del barrido */
+
+	const char* auralize = nullptr;	/* WAV mono que se convoluciona con la respuesta de cada receptor */
+	const char* auralizeOutput = "wav/auralized"; /* Prefijo de los WAV auralizados */
+	int auralizeBlock = 1024;		/* Muestras por bloque de la convolución (potencia de dos) */
+
+	bool bench = false;				/* Ejecuta los microbenchmarks */
+	double benchTime = 0.2;			/* Duración mínima de cada medición en segundos */
+	std::vector<double> benchN = { 8, 32, 128 }; /* Triángulos por cara de las mediciones de energyTrans */
+
+	/**
+	 * @brief Lee los parámetros de la línea de comandos.
+	 * @param argc Número de argumentos
+	 * @param argv Argumentos
+	 * @return Parámetros leídos; los que no aparecen conservan su valor por defecto
+	 */
+	static Settings parse(int argc, char** argv) {
+		Settings s;
+		for (int i = 1; i < argc; i++) {
+			const char* arg = argv[i];
+			const char* value = strchr(arg, '=');
+			value = value ? value + 1 : "";
+
+			if (strcmp(arg, "--trace") == 0) s.trace = true;
+			else if (strcmp(arg, "--images") == 0) s.images = true;
+			else if (strcmp(arg, "--hybrid") == 0) s.hybrid = true;
+			else if (strcmp(arg, "--sweep") == 0) s.sweep = true;
+			else if (strncmp(arg, "--sweep-n=", 10) == 0) s.sweepN = parseList(value);
+			else if (strncmp(arg, "--sweep-loss=", 13) == 0) s.sweepLoss = parseList(value);
+			else if (strncmp(arg, "--sweep-energy=", 15) == 0) s.sweepEnergy = parseList(value);
+			else if (strncmp(arg, "--sweep-rays=", 13) == 0) s.sweepRays = parseList(value);
+			else if (strncmp(arg, "--sweep-output=", 15) == 0) s.sweepOutput = value;
+			else if (strcmp(arg, "--bench") == 0) s.bench = true;
+			else if (strncmp(arg, "--bench-time=", 13) == 0) s.benchTime = atof(value);
+			else if (strncmp(arg, "--bench-n=", 10) == 0) s.benchN = parseList(value);
+			else if (strncmp(arg, "--auralize=", 11) == 0) s.auralize = value;
+			else if (strncmp(arg, "--auralize-output=", 18) == 0) s.auralizeOutput = value;
+			else if (strncmp(arg, "--auralize-block=", 17) == 0) s.auralizeBlock = atoi(value);
+			else if (strncmp(arg, "--crossover=", 12) == 0) s.crossover = atof(value);
+			else if (strncmp(arg, "--fade=", 7) == 0) s.fade = atof(value);
+			else if (strncmp(arg, "--direction=", 12) == 0) s.direction = value;
+			else if (strncmp(arg, "--precision=", 12) == 0) s.precision = value;
+			else if (strncmp(arg, "--threads=", 10) == 0) s.threads = atoi(value);
+			else if (strncmp(arg, "--order=", 8) == 0) s.imageOrder = atoi(value);
+			else if (strncmp(arg, "--receptors=", 12) == 0) s.receptors = atoi(value);
+			else if (strncmp(arg, "--n=", 4) == 0) s.n = atoi(value);
+			else if (strncmp(arg, "--particles=", 12) == 0) s.maxParticles = atoi(value);
+			else if (strncmp(arg, "--sim-rate=", 11) == 0) s.simRate = atof(value);
+			else if (strncmp(arg, "--sim-budget=", 13) == 0) s.simBudget = atof(value);
+			else if (strncmp(arg, "--energy=", 9) == 0) s.energy = (float)atof(value);
+			else if (strncmp(arg, "--loss=", 7) == 0) s.loss = (float)atof(value);
+			else if (strncmp(arg, "--rays=", 7) == 0) s.rays = atoll(value);
+			else if (strncmp(arg, "--chunk=", 8) == 0) s.chunk = atoi(value);
+			else if (strncmp(arg, "--seed=", 7) == 0) s.seed = strtoull(value, nullptr, 10);
+			else if (strncmp(arg, "--time=", 7) == 0) s.maxTime = atof(value);
+			else if (strncmp(arg, "--bin=", 6) == 0) s.binWidth = atof(value);
+			else if (strncmp(arg, "--threshold=", 12) == 0) s.threshold = atof(value);
+			else if (strncmp(arg, "--checkpoint=", 13) == 0) s.checkpoint = value;
+			else if (strncmp(arg, "--checkpoint-interval=", 22) == 0) s.checkpointInterval = atof(value);
+			else if (strcmp(arg, "--resume") == 0) s.resume = true;
+			else if (strncmp(arg, "--scattering=", 13) == 0) s.scattering = (float)atof(value);
+			else if (strncmp(arg, "--materials=", 12) == 0) s.materials = value;
+			else if (strncmp(arg, "--source=", 9) == 0) {
+				std::vector<double> c = parseList(value);
+				if (c.size() == 3) s.sources.push_back(Point(c[0], c[1], c[2]));
+			}
+			else if (strncmp(arg, "--gains=", 8) == 0) s.gains = parseList(value);
+		}
+
+		if (s.sources.empty()) {
+			s.sources.push_back(Point(1.6, 1.6, -1.6));
+		}
+		return s;
+	}
+
+	/**
+	 * @brief Lee una lista de números separados por comas.
+	 * @param value Texto con la lista
+	 * @return Números leídos
+	 */
+	static std::vector<double> parseList(const char* value) {
+		std::vector<double> list;
+		while (*value) {
+			char* end;
+			double number = strtod(value, &end);
+			if (end == value) break;
+			list.push_back(number);
+			value = *end == ',' ? end + 1 : end;
+		}
+		return list;
+	}
+};
+
+#endif // SETTINGS_H
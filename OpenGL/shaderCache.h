@@ -0,0 +1,245 @@
+#ifndef SHADER_CACHE_H
+#define SHADER_CACHE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <learnopengl/shader.h>
+
+/**
+ * @class ShaderCache
+ * @brief Caché de programas GL indexada por las rutas de sus fuentes.
+ * @details Cada par de shaders se lee, compila y enlaza una sola vez por contexto; los objetos guardan un Shader que
+ * solo contiene el identificador del programa compartido, así que copiarlo no crea programas nuevos. Si el
+ * controlador admite binarios de programa (GL 4.1 o ARB_get_program_binary), el programa enlazado se guarda en
+ * disco junto a sus fuentes y en las siguientes ejecuciones se carga sin compilar. El binario lleva un resumen de
+ * las fuentes y del controlador: si cambia cualquiera de los dos, o si el controlador lo rechaza, se recompila.
+ */
+class ShaderCache {
+public:
+	/**
+	 * @brief Devuelve el programa de un par de shaders, compilándolo la primera vez.
+	 * @param vertexPath Ruta del vertex shader
+	 * @param fragmentPath Ruta del fragment shader
+	 * @return Shader con el identificador del programa compartido
+	 */
+	static Shader get(const char* vertexPath, const char* fragmentPath) {
+		std::map<std::string, unsigned int>& programs = instance().programs;
+		std::string key = std::string(vertexPath) + "|" + fragmentPath;
+		std::map<std::string, unsigned int>::iterator it = programs.find(key);
+
+		Shader shader;
+		if (it != programs.end()) {
+			shader.ID = it->second;
+			return shader;
+		}
+
+		shader.ID = load(vertexPath, fragmentPath);
+		programs[key] = shader.ID;
+		return shader;
+	}
+
+	/**
+	 * @brief Borra todos los programas. Debe llamarse con el contexto aún activo, antes de glfwTerminate.
+	 */
+	static void clear() {
+		std::map<std::string, unsigned int>& programs = instance().programs;
+		for (std::map<std::string, unsigned int>::iterator it = programs.begin(); it != programs.end(); ++it) {
+			glDeleteProgram(it->second);
+		}
+		programs.clear();
+	}
+
+	/**
+	 * @brief Número de programas en la caché.
+	 */
+	static size_t size() {
+		return instance().programs.size();
+	}
+
+private:
+	std::map<std::string, unsigned int> programs;	/* Programa de cada par de rutas */
+
+	static ShaderCache& instance() {
+		// No se destruye nunca: los programas se borran con clear() mientras el contexto sigue activo
+		static ShaderCache* cache = new ShaderCache();
+		return *cache;
+	}
+
+	/**
+	 * @brief Crea el programa desde el binario guardado o, si no es válido, compilando las fuentes.
+	 */
+	static unsigned int load(const char* vertexPath, const char* fragmentPath) {
+		std::string vertexCode = readFile(vertexPath);
+		std::string fragmentCode = readFile(fragmentPath);
+
+		bool binaries = binariesSupported();
+		uint64_t digest = 0;
+		std::string binaryPath;
+		if (binaries) {
+			const char* renderer = (const char*)glGetString(GL_RENDERER);
+			const char* version = (const char*)glGetString(GL_VERSION);
+			digest = hash(vertexCode + '\0' + fragmentCode + '\0' + (renderer ? renderer : "") + '\0' + (version ? version : ""));
+			binaryPath = std::string(vertexPath) + ".program";
+
+			unsigned int program = loadBinary(binaryPath.c_str(), digest);
+			if (program) {
+				return program;
+			}
+		}
+
+		// Un programa con errores no se guarda: se volvería a cargar sin avisar en los siguientes arranques
+		bool ok = false;
+		unsigned int program = compile(vertexCode.c_str(), fragmentCode.c_str(), binaries, ok);
+		if (binaries && program && ok) {
+			saveBinary(binaryPath.c_str(), digest, program);
+		}
+		return program;
+	}
+
+	/**
+	 * @brief Indica si el contexto actual permite leer y cargar binarios de programa.
+	 */
+	static bool binariesSupported() {
+		if (!glGetProgramBinary || !glProgramBinary || !glProgramParameteri) {
+			return false;
+		}
+		GLint formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		return formats > 0;
+	}
+
+	static unsigned int compile(const char* vertexCode, const char* fragmentCode, bool retrievable, bool& ok) {
+		unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(vertex, 1, &vertexCode, NULL);
+		glCompileShader(vertex);
+		ok = check(vertex, "VERTEX");
+
+		unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(fragment, 1, &fragmentCode, NULL);
+		glCompileShader(fragment);
+		ok = check(fragment, "FRAGMENT") && ok;
+
+		unsigned int program = glCreateProgram();
+		if (retrievable) {
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+		glAttachShader(program, vertex);
+		glAttachShader(program, fragment);
+		glLinkProgram(program);
+		ok = check(program, "PROGRAM") && ok;
+		glDeleteShader(vertex);
+		glDeleteShader(fragment);
+		return program;
+	}
+
+	/**
+	 * @brief Carga un binario guardado si su resumen coincide y el controlador lo acepta.
+	 * @return Programa, o 0 si hay que compilar
+	 */
+	static unsigned int loadBinary(const char* filename, uint64_t digest) {
+		FILE* file;
+		if (fopen_s(&file, filename, "rb") != 0) {
+			return 0;
+		}
+
+		uint64_t stored = 0;
+		uint32_t format = 0, length = 0;
+		std::vector<char> data;
+		bool ok = fread(&stored, sizeof(stored), 1, file) == 1 && fread(&format, sizeof(format), 1, file) == 1
+			&& fread(&length, sizeof(length), 1, file) == 1 && stored == digest && length > 0;
+		if (ok) {
+			data.resize(length);
+			ok = fread(data.data(), 1, length, file) == length;
+		}
+		fclose(file);
+		if (!ok) {
+			return 0;
+		}
+
+		unsigned int program = glCreateProgram();
+		glProgramBinary(program, (GLenum)format, data.data(), (GLsizei)length);
+		GLint linked = 0;
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+		if (!linked) {
+			glDeleteProgram(program);
+			return 0;
+		}
+		return program;
+	}
+
+	static void saveBinary(const char* filename, uint64_t digest, unsigned int program) {
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) {
+			return;
+		}
+		std::vector<char> data(length);
+		GLenum format = 0;
+		glGetProgramBinary(program, length, NULL, &format, data.data());
+
+		FILE* file;
+		if (fopen_s(&file, filename, "wb") != 0) {
+			return;
+		}
+		uint32_t f = format, l = (uint32_t)length;
+		fwrite(&digest, sizeof(digest), 1, file);
+		fwrite(&f, sizeof(f), 1, file);
+		fwrite(&l, sizeof(l), 1, file);
+		fwrite(data.data(), 1, length, file);
+		fclose(file);
+	}
+
+	static bool check(unsigned int object, const char* type) {
+		int success;
+		char infoLog[1024];
+		bool program = type[0] == 'P';
+		if (program) {
+			glGetProgramiv(object, GL_LINK_STATUS, &success);
+		}
+		else {
+			glGetShaderiv(object, GL_COMPILE_STATUS, &success);
+		}
+		if (!success) {
+			if (program) {
+				glGetProgramInfoLog(object, 1024, NULL, infoLog);
+			}
+			else {
+				glGetShaderInfoLog(object, 1024, NULL, infoLog);
+			}
+			std::cout << "ERROR::SHADER_CACHE " << type << "\n" << infoLog << std::endl;
+		}
+		return success != 0;
+	}
+
+	static std::string readFile(const char* path) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file) {
+			std::cout << "ERROR::SHADER_CACHE::FILE_NOT_READ " << path << std::endl;
+			return std::string();
+		}
+		std::stringstream stream;
+		stream << file.rdbuf();
+		return stream.str();
+	}
+
+	/**
+	 * @brief FNV-1a de 64 bits.
+	 */
+	static uint64_t hash(const std::string& s) {
+		uint64_t h = 14695981039346656037ULL;
+		for (size_t i = 0; i < s.size(); i++) {
+			h = (h ^ (unsigned char)s[i]) * 1099511628211ULL;
+		}
+		return h;
+	}
+};
+
+#endif // SHADER_CACHE_H
@@ -0,0 +1,29 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 aPositionEnergy;
+layout (location = 2) in vec4 aColor;
+layout (location = 3) in float aScaled;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float time;
+
+out vec4 particleColor;
+
+// Same model matrix as translate * scale * rotateZ * rotateX * rotateY, with the angle time * energy and the scale
+// 0.02 * energy / 5 (0.02 for particles that do not scale)
+void main()
+{
+    float angle = time * aPositionEnergy.w;
+    float scale = 0.02 * (aScaled > 0.5 ? aPositionEnergy.w / 5.0 : 1.0);
+    float c = cos(angle);
+    float s = sin(angle);
+
+    vec3 p = aPos;
+    p = vec3(p.x * c + p.z * s, p.y, -p.x * s + p.z * c);
+    p = vec3(p.x, p.y * c - p.z * s, p.y * s + p.z * c);
+    p = vec3(p.x * c - p.y * s, p.x * s + p.y * c, p.z);
+
+    particleColor = aColor;
+    gl_Position = projection * view * vec4(aPositionEnergy.xyz + p * scale, 1.0);
+}
\ No newline at end of file
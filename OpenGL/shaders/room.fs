@@ -1,7 +1,7 @@
 #version 330 core
 out vec4 FragColor;
-uniform vec4 triangle_color;
+in vec4 triangleColor;
 void main()
 {
-   FragColor = triangle_color;
+   FragColor = triangleColor;
 }
\ No newline at end of file
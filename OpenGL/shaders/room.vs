@@ -1,11 +1,17 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
+layout (location = 1) in float aEnergy;
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+uniform vec4 baseColor;
+
+out vec4 triangleColor;
 
 void main()
 {
+   // Energy received by the triangle shifts its color from blue towards red
+   triangleColor = baseColor + vec4(aEnergy, -aEnergy, -aEnergy, 0.0);
    gl_Position = projection * view * model * vec4(aPos, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,340 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "room.h"
+#include "transferJob.h"
+#include "source.h"
+#include "receptor.h"
+#include "particle.h"
+#include "profiler.h"
+#include "counters.h"
+
+/**
+ * @class TripleBuffer
+ * @brief Intercambio sin bloqueos de un valor entre un productor y un consumidor.
+ * @details Hay tres copias: la que escribe el productor, la que lee el consumidor y una intermedia. Publicar cambia la
+ * copia escrita por la intermedia y marca esta como nueva; leer cambia la copia leída por la intermedia si hay una
+ * nueva. Cada lado trabaja sobre su copia sin esperar al otro, y el consumidor siempre ve el último valor completo
+ * (los intermedios que no llega a leer se descartan).
+ */
+template <typename T>
+class TripleBuffer {
+public:
+	static const int FRESH = 4;	/* Marca de copia intermedia sin leer */
+
+	T slots[3];					/* Copias del valor */
+	int back;					/* Copia del productor */
+	int front;					/* Copia del consumidor */
+	std::atomic<int> middle;	/* Copia intermedia y marca FRESH */
+
+	TripleBuffer() : back(0), front(1), middle(2) {}
+
+	/**
+	 * @brief Copia que puede rellenar el productor.
+	 */
+	T& write() {
+		return slots[back];
+	}
+
+	/**
+	 * @brief Publica la copia del productor.
+	 */
+	void publish() {
+		back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & ~FRESH;
+	}
+
+	/**
+	 * @brief Toma la última copia publicada, si la hay.
+	 * @return true si la copia del consumidor ha cambiado
+	 */
+	bool update() {
+		if (!(middle.load(std::memory_order_relaxed) & FRESH)) {
+			return false;
+		}
+		front = middle.exchange(front, std::memory_order_acq_rel) & ~FRESH;
+		return true;
+	}
+
+	/**
+	 * @brief Copia del consumidor.
+	 */
+	const T& read() const {
+		return slots[front];
+	}
+};
+
+/**
+ * @brief Estado de la simulación que necesita el dibujo de un frame.
+ */
+struct SimulationSnapshot {
+	long long sequence;							/* Número de publicación (empieza en 1) */
+	double time;								/* Segundos simulados */
+	std::vector<ParticleInstance> particles;	/* Partículas vivas */
+	std::vector<float> triangleEnergy;			/* Energía de cada triángulo de la habitación */
+	std::vector<int> dirtyBegin;				/* Rango de triángulos de cada plano que ha cambiado desde la última publicación que tomó la ventana */
+	std::vector<int> dirtyEnd;
+	std::vector<glm::vec4> receptorColors;		/* Color de cada receptor */
+
+	SimulationSnapshot() : sequence(0), time(0) {}
+};
+
+/**
+ * @class Simulation
+ * @brief Hilo que avanza la simulación interactiva con un paso fijo, independiente del dibujo.
+ * @details El hilo es el único que modifica la habitación, los receptores y las partículas de las fuentes. Trabaja
+ * por frames de `frame` segundos de reloj: en cada uno avanza varios pasos fijos de 1 / rate segundos simulados, copia
+ * lo que se dibuja en un SimulationSnapshot y lo publica en un TripleBuffer, así que la ventana dibuja a su ritmo
+ * sin bloqueos.
+ *
+ * Sin presupuesto (`budget` = 0) avanza en tiempo real: `rate` pasos por segundo de reloj. Con presupuesto avanza
+ * tantos pasos como quepan en `budget` segundos de cálculo por frame; el número de pasos se estima con la media del
+ * coste de los pasos anteriores, así que se adapta cuando cambia la carga (por ejemplo al morir partículas), y el
+ * reloj corta el frame si la estimación se queda corta. En ambos casos `speed` da los segundos simulados por
+ * segundo de reloj.
+ */
+class Simulation {
+public:
+	static const int HISTORY = 16;	/* Publicaciones cuyo rango modificado se recuerda */
+
+	Room* room;						/* Habitación */
+	Receptor* receptors;			/* Receptores */
+	int numReceptors;				/* Número de receptores */
+	std::vector<Source>* sources;	/* Fuentes con sus partículas */
+	TransferJob* transfer;			/* Cálculo en curso de la matriz de energía completa (puede ser nullptr) */
+	double rate;					/* Pasos por segundo simulado */
+	double frame;					/* Segundos de reloj de cada frame del planificador */
+	double budget;					/* Segundos de cálculo por frame; 0 avanza en tiempo real */
+	double time;					/* Segundos simulados */
+	double stepCost;				/* Media móvil de los segundos de reloj que cuesta un paso */
+	long long published;			/* Publicaciones hechas */
+	std::vector<int> historyBegin[HISTORY];	/* Rango modificado por plano de cada una de las últimas publicaciones */
+	std::vector<int> historyEnd[HISTORY];
+	std::vector<int> copyBegin;				/* Rango por plano que publish copia en la copia del productor */
+	std::vector<int> copyEnd;
+
+	TripleBuffer<SimulationSnapshot> snapshots;	/* Estado publicado para la ventana */
+	std::atomic<bool> running;					/* Indica si las partículas avanzan (la ventana lo cambia) */
+	std::atomic<bool> stopping;					/* Pide al hilo que termine */
+	std::atomic<long long> drawn;				/* Última publicación que ha tomado la ventana */
+	std::atomic<int> substeps;					/* Pasos del último frame */
+	std::atomic<double> speed;					/* Segundos simulados por segundo de reloj */
+	std::thread thread;							/* Hilo de la simulación */
+
+	/**
+	 * @brief Constructor de la clase Simulation.
+	 * @param r Habitación
+	 * @param rs Receptores
+	 * @param nr Número de receptores
+	 * @param s Fuentes
+	 * @param stepsPerSecond Pasos por segundo simulado
+	 * @param frameBudget Segundos de cálculo por frame; 0 avanza en tiempo real
+	 */
+	Simulation(Room* r, Receptor* rs, int nr, std::vector<Source>* s, double stepsPerSecond, double frameBudget)
+		: room(r), receptors(rs), numReceptors(nr), sources(s), transfer(nullptr), rate(stepsPerSecond), frame(1.0 / 60), budget(frameBudget), time(0), stepCost(0), published(0),
+		running(false), stopping(false), drawn(0), substeps(0), speed(0) {}
+
+	~Simulation() {
+		stop();
+	}
+
+	/**
+	 * @brief Publica el estado inicial y arranca el hilo.
+	 */
+	void start() {
+		publish();
+		thread = std::thread([this]() { loop(); });
+	}
+
+	/**
+	 * @brief Detiene el hilo. Después la habitación, los receptores y las fuentes vuelven a ser del llamante.
+	 */
+	void stop() {
+		stopping.store(true);
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+
+	/**
+	 * @brief Avanza todas las partículas un paso y resuelve sus colisiones.
+	 * @param dt Segundos simulados del paso
+	 */
+	void step(float dt) {
+		PROFILE_ZONE("Simulation step");
+		long long stepped = 0;
+		float now = (float)(time + dt);
+		for (size_t s = 0; s < sources->size(); s++) {
+			std::vector<Particle>& particles = (*sources)[s].particles;
+			for (size_t i = 0; i < particles.size(); i++) {
+				// Las partículas muertas liberan su hueco
+				if (!particles[i].alive) {
+					particles[i] = particles.back();
+					particles.pop_back();
+					i--;
+					continue;
+				}
+
+				particles[i].move(dt);
+				room->handleParticleCollision(particles[i]);
+				for (int j = 0; j < numReceptors; j++) {
+					receptors[j].handleParticleCollision(particles[i], now, true);
+				}
+				stepped++;
+			}
+		}
+		time += dt;
+		Counters::add(STEPS, stepped);
+	}
+
+	/**
+	 * @brief Copia el estado actual en la copia del productor y la publica.
+	 * @details El rango modificado de cada plano en la copia es la unión de sus rangos en todas las publicaciones
+	 * posteriores a la última que tomó la ventana, así que aunque la ventana se salte publicaciones solo sube lo que ha
+	 * cambiado. Si se ha saltado más de HISTORY, el rango es la habitación entera. La energía de los triángulos se copia
+	 * igual: la copia ya tiene la de la última publicación que se hizo en ella, así que solo se copian los rangos
+	 * modificados desde entonces.
+	 */
+	void publish() {
+		PROFILE_ZONE("Simulation publish");
+		SimulationSnapshot& s = snapshots.write();
+		long long last = s.sequence;
+		s.sequence = ++published;
+		s.time = time;
+
+		s.particles.clear();
+		for (size_t k = 0; k < sources->size(); k++) {
+			const std::vector<Particle>& particles = (*sources)[k].particles;
+			for (size_t i = 0; i < particles.size(); i++) {
+				if (particles[i].alive) {
+					s.particles.push_back(particles[i].instance());
+				}
+			}
+		}
+
+		historyBegin[s.sequence % HISTORY] = room->dirtyBegin;
+		historyEnd[s.sequence % HISTORY] = room->dirtyEnd;
+		room->clearDirty();
+		if (last == 0 || s.triangleEnergy.size() != room->triangleEnergy.size()) {
+			s.triangleEnergy = room->triangleEnergy;
+		}
+		else {
+			merge(last + 1, s.sequence, copyBegin, copyEnd);
+			for (int p = 0; p < room->numPlanes; p++) {
+				if (copyBegin[p] < copyEnd[p]) {
+					std::copy(room->triangleEnergy.begin() + copyBegin[p], room->triangleEnergy.begin() + copyEnd[p], s.triangleEnergy.begin() + copyBegin[p]);
+				}
+			}
+		}
+		merge(drawn.load(std::memory_order_acquire) + 1, s.sequence, s.dirtyBegin, s.dirtyEnd);
+
+		s.receptorColors.resize(numReceptors);
+		for (int j = 0; j < numReceptors; j++) {
+			s.receptorColors[j] = receptors[j].getReceptorColor();
+		}
+		snapshots.publish();
+	}
+
+private:
+	/**
+	 * @brief Une el rango modificado de cada plano en las publicaciones de `from` a `to`. Si son más de HISTORY, el
+	 * rango es el plano entero.
+	 */
+	void merge(long long from, long long to, std::vector<int>& begin, std::vector<int>& end) const {
+		int planes = room->numPlanes, triangles = room->numTriangles;
+		begin.resize(planes);
+		end.resize(planes);
+		for (int p = 0; p < planes; p++) {
+			if (to - from >= HISTORY) {
+				begin[p] = p * triangles;
+				end[p] = (p + 1) * triangles;
+				continue;
+			}
+			begin[p] = (p + 1) * triangles;
+			end[p] = p * triangles;
+			for (long long q = from; q <= to; q++) {
+				begin[p] = historyBegin[q % HISTORY][p] < begin[p] ? historyBegin[q % HISTORY][p] : begin[p];
+				end[p] = historyEnd[q % HISTORY][p] > end[p] ? historyEnd[q % HISTORY][p] : end[p];
+			}
+		}
+	}
+
+	void loop() {
+		typedef std::chrono::steady_clock Clock;
+		Clock::time_point next = Clock::now();
+		Clock::time_point window = next;	/* Inicio de la ventana en que se mide speed */
+		double windowTime = time;			/* Segundos simulados al inicio de la ventana */
+		double owed = 0;					/* Pasos pendientes para ir en tiempo real */
+		float dt = (float)(1.0 / rate);
+
+		while (!stopping.load(std::memory_order_relaxed)) {
+			// La matriz de energía completa sustituye a la aproximada en cuanto está calculada
+			if (transfer) {
+				transfer->apply();
+			}
+
+			if (!running.load(std::memory_order_relaxed)) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+				next = window = Clock::now();
+				windowTime = time;
+				owed = 0;
+				speed.store(0, std::memory_order_relaxed);
+				continue;
+			}
+
+			// Pasos del frame: los que tocan en tiempo real o los que caben en el presupuesto
+			Clock::time_point start = Clock::now();
+			int target;
+			double limit;
+			if (budget > 0) {
+				target = stepCost > 0 ? (int)(budget / stepCost) : 1;
+				target = target > 0 ? target : 1;
+				limit = budget;
+			}
+			else {
+				owed += frame * rate;
+				target = (int)owed;
+				owed -= target;
+				limit = frame;
+			}
+
+			int done = 0;
+			double elapsed = 0;
+			while (done < target && elapsed < limit) {
+				step(dt);
+				done++;
+				elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+			}
+			if (done > 0) {
+				double cost = elapsed / done;
+				stepCost = stepCost > 0 ? 0.8 * stepCost + 0.2 * cost : cost;
+			}
+			substeps.store(done, std::memory_order_relaxed);
+			publish();
+
+			Clock::time_point now = Clock::now();
+			double seconds = std::chrono::duration<double>(now - window).count();
+			if (seconds >= 0.5) {
+				speed.store((time - windowTime) / seconds, std::memory_order_relaxed);
+				window = now;
+				windowTime = time;
+			}
+
+			// Si el frame se ha pasado de su duración no se acumulan frames pendientes
+			next += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(frame));
+			if (next > now) {
+				std::this_thread::sleep_until(next);
+			}
+			else {
+				next = now;
+			}
+		}
+	}
+};
+
+#endif // SIMULATION_H
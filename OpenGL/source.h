@@ -6,6 +6,8 @@
 #include "point.h"
 #include "triangle.h"
 #include "particle.h"
+#include "counters.h"
+#include "shaderCache.h"
 
 constexpr auto PI = 3.14159265358979323846; /* pi */
 const glm::vec4 DEFAULT_SOURCE_COLOR = glm::vec4(1, 0.82, 0.31, 1); /* Color por defecto de la fuente */
@@ -13,7 +15,7 @@ const glm::vec4 DEFAULT_SOURCE_COLOR = glm::vec4(1, 0.82, 0.31, 1); /* Color por
 unsigned int sourceVAO; /* Vertex Array Object */
 unsigned int sourceVBO; /* Vertex Buffer Object */
 
-const Point errorTranslation = { -0.061, 0.066, 0.025 }; /* Traslacin para corregir el erro en la posicin de la fuente */
+const Point errorTranslation = { -0.061, 0.066, 0.025 }; /* Traslación para corregir el erro en la posición de la fuente */
 
 /* Vertices del icosaedro */
 float icosahedron[] = {
@@ -100,7 +102,7 @@ float icosahedron[] = {
 
 /**
  * @class Source
- * @brief Clase que representa una fuente de partculas
+ * @brief Clase que representa una fuente de partículas
  */
 class Source {
 private:
@@ -108,7 +110,7 @@ private:
 	glm::vec4 sourceColor; /* Color de la fuente */
 
 	/**
-	 * @brief Genera los tringulos que forman la fuente en base a los vrtices del icosaedro.
+	 * @brief Genera los triángulos que forman la fuente en base a los vértices del icosaedro.
 	 */
 	void genTriangles() {
 		int j = 0;
@@ -125,17 +127,17 @@ private:
 		}
 	}
 public:
-	int size;			/* Nmero de caras de la fuente */
+	int size;			/* Número de caras de la fuente */
 	int ID;	/* Nombre de la fuente */
-	int numParticles;	/* Nmero de partculas */
+	int numParticles;	/* Número de partículas */
 	float scale;		/* Escala de la fuente */
-	Point position;		/* Posicin de la fuente */
-	float energy;		/* Energa de la fuente y de todas las particulas que contiene */
-	float loss;			/* Prdida de energa de la fuente y de todas las partculas que contiene */
+	Point position;		/* Posición de la fuente */
+	float energy;		/* Energía de la fuente y de todas las paráticulas que contiene */
+	float loss;			/* Pérdida de energía de la fuente y de todas las partículas que contiene */
 
-	std::vector<Particle> particles; /* Partculas que contiene la fuente */
-	std::vector<Point> positions;	 /* Posiciones de las partculas que contiene la fuente */
-	std::vector<Triangle> triangles; /* Tringulos que forman la fuente */
+	std::vector<Particle> particles; /* Partículas que contiene la fuente */
+	std::vector<Point> positions;	 /* Posiciones de las partículas que contiene la fuente */
+	std::vector<Triangle> triangles; /* Triángulos que forman la fuente */
 
 	/**
 	 * @brief Elimina los buffers de la fuente.
@@ -162,16 +164,16 @@ public:
 
 	/**
 	 * @brief Constructor de la clase Source.
-	 * @param p Posicin de la fuente
-	 * @param n Nmero de partculas
-	 * @param e Energa de la fuente
-	 * @param l Prdida de energa de la fuente
+	 * @param p Posición de la fuente
+	 * @param n Número de partículas
+	 * @param e Energía de la fuente
+	 * @param l Pérdida de energía de la fuente
 	 * @param s Escala de la fuente
 	 */
 	Source(Point p, int n, float e, float l) {
 		size = 20 * 3;
 		ID = -1;
-		shader = Shader("shaders/cube.vs", "shaders/cube.fs");
+		shader = ShaderCache::get("shaders/cube.vs", "shaders/cube.fs");
 		sourceColor = DEFAULT_SOURCE_COLOR;
 		scale = 1.0f;
 		energy = e/n;
@@ -181,47 +183,54 @@ public:
 
 		genTriangles();
 
-		for (int i = 0; i < triangles.size(); i++) {
-			std::vector<Vect> tempDirs = genParticlesDirection(triangles[i], numParticles / triangles.size());
-			for (int j = 0; j < tempDirs.size(); j++) {
+		for (size_t i = 0; i < triangles.size(); i++) {
+			std::vector<Vec3> tempDirs = genParticlesDirection(triangles[i], numParticles / triangles.size());
+			for (size_t j = 0; j < tempDirs.size(); j++) {
 				Particle temp = Particle(energy, loss, triangles[i].getBarycenter(), tempDirs[j]);
 				temp.setName("Particle " + std::to_string(i) + " " + std::to_string(j));
 				particles.push_back(temp);
 			}
 		}
+		Counters::add(RAYS_EMITTED, particles.size());
 	}
 
 	/**
-	 * @brief Obtiene todas las direcciones de las partculas que se generan en un tringulo en base a la normal del tringulo.
-	 * Las partculas se generan en forma de abanico con un ngulo de separacin de 15 grados. Luego, los vectores subsecuentes se
-	 * obtienen rotando el primer vector en el eje normal del tringulo.
+	 * @brief Obtiene todas las direcciones de las partículas que se generan en un triángulo en base a la normal del triángulo.
+	 * Las partículas se generan en forma de abanico con un ángulo de separación de 15 grados. Luego, los vectores subsecuentes se
+	 * obtienen rotando el primer vector en el eje normal del triángulo.
 	 *
-	 * @param t Tringulo
-	 * @param vectPerTriangle Nmero de partculas que se generan en el tringulo
-	 * @return std::vector<Vect> Direcciones de las partculas
+	 * @param t Triángulo
+	 * @param vectPerTriangle Número de partículas que se generan en el triángulo
+	 * @return std::vector<Vec3> Direcciones de las partículas
 	 */
-	std::vector<Vect> genParticlesDirection(Triangle t, int vectPerTriangle) {
-		std::vector<Vect> vects;
+	std::vector<Vec3> genParticlesDirection(const Triangle& t, int vectPerTriangle) {
+		std::vector<Vec3> vects;
+		vects.reserve(vectPerTriangle);
 
 		const float angleSep = 15;
 
-		Vect normal = t.getNormal();
+		Vec3 normal = t.getNormal();
 		vects.push_back(normal);
 
-		Vect perpendicular = Vect(t.getA(), t.getB()).unit();
-		perpendicular.setStart(t.getBarycenter());
-
-		Vect firstVect = Vect::rodriges(perpendicular, normal, angleSep * PI / 180).unit();
-		firstVect.setStart(t.getBarycenter());
+		Vec3 perpendicular = Vec3::between(t.getA(), t.getB()).unit();
+		Vec3 firstVect = normal.rotate(perpendicular, angleSep * PI / 180).unit();
 
 		for (int i = 0; i < vectPerTriangle - 1; i++) {
-			Vect rot = Vect::rodriges(normal, firstVect, 2 * i * PI / (vectPerTriangle - 1));
-			rot.setStart(t.getBarycenter());
-			vects.push_back(rot);
+			vects.push_back(firstVect.rotate(normal, 2 * i * PI / (vectPerTriangle - 1)));
 		}
 		return vects;
 	}
 
+	/**
+	 * @brief Configura el umbral de energía de la ruleta rusa de todas las partículas.
+	 * @param ratio Umbral relativo a la energía inicial de cada partícula (0 la desactiva)
+	 */
+	void setEnergyFloor(float ratio) {
+		for (size_t i = 0; i < particles.size(); i++) {
+			particles[i].energyFloor = energy * ratio;
+		}
+	}
+
 	/**
 	 * @brief Configura el color de la fuente.
 	 */
@@ -241,7 +250,7 @@ public:
 	 * @param deltaTime Tiempo entre frames
 	 * @param currentFrame Tiempo actual
 	 * @param view Matriz de vista
-	 * @param projection Matriz de proyeccin
+	 * @param projection Matriz de proyección
 	 */
 	void transform(float deltaTime, float currentFrame, glm::mat4 view, glm::mat4 projection) {
 		shader.use();
@@ -0,0 +1,180 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include "room.h"
+#include "emitter.h"
+#include "histogram.h"
+#include "crossover.h"
+#include "hybrid.h"
+#include "parallel.h"
+#include "profiler.h"
+
+/**
+ * @brief Configuración de un punto del barrido.
+ */
+struct SweepPoint {
+	int n;				/* Triángulos por cara */
+	float loss;			/* Pérdida de energía por reflexión */
+	float energy;		/* Energía de cada fuente */
+	long long rays;		/* Rayos por fuente */
+};
+
+/**
+ * @brief Resumen de la respuesta de un punto del barrido.
+ */
+struct SweepResult {
+	SweepPoint point;				/* Configuración */
+	long long raysTraced;			/* Rayos trazados */
+	long long images;				/* Imágenes usadas en la parte temprana */
+	double seconds;					/* Tiempo de cálculo en segundos */
+	double received[NUM_BANDS];		/* Energía total recibida por banda, media de los receptores */
+};
+
+/**
+ * @class Sweep
+ * @brief Barrido de parámetros sobre una malla de configuraciones.
+ * @details Las configuraciones se agrupan por número de triángulos: la habitación de cada grupo se construye una sola
+ * vez y un motor ya preparado (planos, materiales y caja de fuentes imagen) se copia a cada hilo. Dentro de un grupo
+ * las configuraciones se reparten entre los hilos. Solo hay una habitación y un motor por hilo en memoria a la vez,
+ * y de cada configuración se guarda únicamente su resumen.
+ */
+class Sweep {
+public:
+	std::vector<int> ns;				/* Valores de triángulos por cara */
+	std::vector<float> losses;			/* Valores de pérdida por reflexión */
+	std::vector<float> energies;		/* Valores de energía de las fuentes */
+	std::vector<long long> rays;		/* Valores de rayos por fuente */
+	std::vector<Point> sources;			/* Posiciones de las fuentes */
+	std::vector<double> gains;			/* Ganancia de energía de cada fuente */
+	std::vector<Point> receptors;		/* Centros de los receptores */
+	double radio;						/* Radio de los receptores */
+	double binWidth;					/* Ancho de los intervalos de los histogramas en segundos */
+	double maxTime;						/* Duración máxima de la respuesta en segundos */
+	Crossover crossover;				/* Transición de la respuesta híbrida (inactiva: solo trazado de rayos) */
+	int chunkSize;						/* Rayos por bloque */
+	bool singlePrecision;				/* Propaga los rayos en float en lugar de double */
+	double threshold;					/* Umbral relativo de energía */
+	uint64_t seed;						/* Semilla de la primera fuente */
+	std::vector<SweepResult> results;	/* Resumen de cada configuración, en el orden de la malla */
+
+	/**
+	 * @brief Devuelve todas las configuraciones de la malla, agrupadas por número de triángulos.
+	 */
+	std::vector<SweepPoint> grid() const {
+		std::vector<SweepPoint> points;
+		for (size_t a = 0; a < ns.size(); a++) {
+			for (size_t b = 0; b < losses.size(); b++) {
+				for (size_t c = 0; c < energies.size(); c++) {
+					for (size_t d = 0; d < rays.size(); d++) {
+						SweepPoint p;
+						p.n = ns[a];
+						p.loss = losses[b];
+						p.energy = energies[c];
+						p.rays = rays[d];
+						points.push_back(p);
+					}
+				}
+			}
+		}
+		return points;
+	}
+
+	/**
+	 * @brief Calcula todas las configuraciones de la malla.
+	 * @param threads Número de hilos
+	 * @param prepare Función que completa cada habitación recién construida (por ejemplo, sus materiales)
+	 */
+	void run(int threads, const std::function<void(Room&)>& prepare) {
+		std::vector<SweepPoint> points = grid();
+		results.assign(points.size(), SweepResult());
+
+		const int faces = 6;
+		size_t begin = 0;
+		while (begin < points.size()) {
+			size_t end = begin;
+			while (end < points.size() && points[end].n == points[begin].n) {
+				end++;
+			}
+
+			// Una habitación por grupo, compartida en solo lectura; un motor por hilo
+			Room room = Room(points[begin].n, faces, 0, nullptr, TRANSFER_NONE);
+			prepare(room);
+			Hybrid prototype = Hybrid(room, receptors, radio, binWidth, maxTime, crossover, chunkSize, threshold);
+			prototype.tracer.singlePrecision = singlePrecision;
+			int count = (int)(end - begin);
+			std::vector<Hybrid> engines(std::max(1, std::min(threads, count)), prototype);
+
+			parallelFor(count, (int)engines.size(), [&](int i, int worker) {
+				results[begin + i] = runPoint(engines[worker], points[begin + i]);
+			});
+			begin = end;
+		}
+	}
+
+	/**
+	 * @brief Calcula una configuración y resume su respuesta.
+	 * @param engine Motor del hilo, ya preparado para la habitación de la configuración
+	 * @param p Configuración
+	 */
+	SweepResult runPoint(Hybrid& engine, const SweepPoint& p) const {
+		PROFILE_ZONE("Sweep::runPoint");
+		SweepResult result;
+		result.point = p;
+		std::fill(result.received, result.received + NUM_BANDS, 0.0);
+		engine.images = 0;
+		engine.rays = 0;
+
+		auto start = std::chrono::steady_clock::now();
+		for (size_t s = 0; s < sources.size(); s++) {
+			Emitter emitter = Emitter(sources[s], p.rays, p.energy, p.loss, seed + s);
+			engine.run(emitter);
+			double gain = s < gains.size() ? gains[s] : 1.0;
+			for (size_t r = 0; r < engine.histograms.size(); r++) {
+				for (int b = 0; b < NUM_BANDS; b++) {
+					result.received[b] += gain * engine.histograms[r].total(b) / engine.histograms.size();
+				}
+			}
+		}
+		result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		result.raysTraced = engine.rays;
+		result.images = engine.images;
+		return result;
+	}
+
+	/**
+	 * @brief Guarda el resumen de todas las configuraciones en un único archivo CSV con cabecera.
+	 * @param filename Nombre del archivo
+	 */
+	void exportCSV(const char* filename) const {
+		FILE* file;
+		if (fopen_s(&file, filename, "w") != 0) {
+			perror("Error al abrir el archivo");
+			return;
+		}
+
+		fprintf(file, "n,loss,energy,rays,raysTraced,images,seconds");
+		for (int b = 0; b < NUM_BANDS; b++) {
+			fprintf(file, ",E%d", (int)BAND_FREQUENCIES[b]);
+		}
+		fprintf(file, "\n");
+
+		for (size_t i = 0; i < results.size(); i++) {
+			const SweepResult& r = results[i];
+			fprintf(file, "%d,%.6f,%.6f,%lld,%lld,%lld,%.6f", r.point.n, r.point.loss, r.point.energy, r.point.rays, r.raysTraced, r.images, r.seconds);
+			for (int b = 0; b < NUM_BANDS; b++) {
+				fprintf(file, ",%.6f", r.received[b]);
+			}
+			fprintf(file, "\n");
+		}
+
+		fclose(file);
+	}
+};
+
+#endif // SWEEP_H
@@ -0,0 +1,402 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <iostream>
+#include <vector>
+
+#include "point.h"
+#include "vec3.h"
+#include "room.h"
+#include "csv.h"
+#include "emitter.h"
+#include "histogram.h"
+#include "random.h"
+#include "crossover.h"
+#include "profiler.h"
+#include "counters.h"
+
+/**
+ * @brief Ecuación de un plano de la habitación: n·x + d = 0, con la normal apuntando hacia el interior.
+ */
+template <typename Real>
+struct PlaneEq {
+	Real nx, ny, nz;	/* Normal unitaria del plano */
+	Real d;				/* Término independiente */
+};
+
+/**
+ * @brief Calcula el plano más cercano en la dirección de cada rayo de un intervalo del bloque.
+ * @param walls Planos de la habitación
+ * @param numWalls Número de planos
+ * @param batch Bloque de rayos; el resultado queda en `wall` y `hitTime`
+ * @param begin Primer rayo
+ * @param end Rayo siguiente al último
+ */
+template <typename Real>
+void nearestWalls(const PlaneEq<Real>* walls, int numWalls, RayBatchT<Real>& batch, int begin, int end) {
+	for (int i = begin; i < end; i++) {
+		Real ox = batch.ox[i], oy = batch.oy[i], oz = batch.oz[i];
+		Real dx = batch.dx[i], dy = batch.dy[i], dz = batch.dz[i];
+		int hit = -1;
+		Real tMin = (Real)1e30;
+		for (int w = 0; w < numWalls; w++) {
+			Real dn = walls[w].nx * dx + walls[w].ny * dy + walls[w].nz * dz;
+			if (dn < 0) {
+				Real t = -(walls[w].nx * ox + walls[w].ny * oy + walls[w].nz * oz + walls[w].d) / dn;
+				if (t < tMin) {
+					tMin = t;
+					hit = w;
+				}
+			}
+		}
+		batch.wall[i] = hit;
+		batch.hitTime[i] = tMin;
+	}
+}
+
+#if defined(__AVX__)
+/**
+ * @brief Versión en precisión simple que procesa ocho rayos por instrucción AVX. Los rayos que no completan un
+ * grupo de ocho se calculan con la versión escalar.
+ */
+inline void nearestWalls(const PlaneEq<float>* walls, int numWalls, RayBatchT<float>& batch, int begin, int end) {
+	const __m256 zero = _mm256_setzero_ps();
+	int i = begin;
+	for (; i + 8 <= end; i += 8) {
+		__m256 ox = _mm256_loadu_ps(&batch.ox[i]), oy = _mm256_loadu_ps(&batch.oy[i]), oz = _mm256_loadu_ps(&batch.oz[i]);
+		__m256 dx = _mm256_loadu_ps(&batch.dx[i]), dy = _mm256_loadu_ps(&batch.dy[i]), dz = _mm256_loadu_ps(&batch.dz[i]);
+		__m256 tMin = _mm256_set1_ps(1e30f);
+		__m256 hit = _mm256_set1_ps(-1.0f);
+		for (int w = 0; w < numWalls; w++) {
+			__m256 nx = _mm256_set1_ps(walls[w].nx), ny = _mm256_set1_ps(walls[w].ny), nz = _mm256_set1_ps(walls[w].nz);
+			__m256 dn = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, dx), _mm256_mul_ps(ny, dy)), _mm256_mul_ps(nz, dz));
+			__m256 on = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, ox), _mm256_mul_ps(ny, oy)), _mm256_mul_ps(nz, oz)), _mm256_set1_ps(walls[w].d));
+			__m256 t = _mm256_div_ps(_mm256_sub_ps(zero, on), dn);
+
+			// Los carriles con dn >= 0 pueden dar infinito o NaN; la máscara los descarta
+			__m256 closer = _mm256_and_ps(_mm256_cmp_ps(dn, zero, _CMP_LT_OQ), _mm256_cmp_ps(t, tMin, _CMP_LT_OQ));
+			tMin = _mm256_blendv_ps(tMin, t, closer);
+			hit = _mm256_blendv_ps(hit, _mm256_set1_ps((float)w), closer);
+		}
+		_mm256_storeu_ps(&batch.hitTime[i], tMin);
+		_mm256_storeu_si256((__m256i*)&batch.wall[i], _mm256_cvtps_epi32(hit));
+	}
+	nearestWalls<float>(walls, numWalls, batch, i, end);
+}
+#endif
+
+/**
+ * @class Tracer
+ * @brief Motor de trazado de rayos sin ventana que recorre los rayos de un Emitter por bloques de tamaño fijo.
+ * @details Cada rayo se propaga de reflexión en reflexión hasta superar la duración máxima de la respuesta. La
+ * energía que atraviesa la esfera de un receptor se acumula en su histograma energía-tiempo. La memoria usada no
+ * depende del número total de rayos, solo del tamaño del bloque.
+ *
+ * Los rayos cuya energía cae por debajo de un umbral se someten a ruleta rusa: sobreviven con probabilidad
+ * energía / umbral y, si sobreviven, su energía se eleva al umbral. El estimador sigue siendo insesgado.
+ *
+ * En cada reflexión se consulta el material del triángulo alcanzado: la reflexión es difusa (Lambert) con
+ * probabilidad igual a su coeficiente de dispersión y especular en caso contrario.
+ *
+ * Con una transición activa, los rayos que solo han tenido reflexiones especulares se ponderan con el peso tardío,
+ * ya que la parte temprana especular la aporta el método de fuentes imagen. Los rayos difusos se acumulan siempre.
+ *
+ * La propagación puede hacerse en double o en float (`singlePrecision`). En float la búsqueda del plano alcanzado
+ * procesa ocho rayos por instrucción con AVX; los histogramas, la distancia recorrida y el precálculo de la
+ * habitación siguen en double.
+ */
+class Tracer {
+public:
+	Room* room;							/* Habitación (geometría y tabla de materiales) */
+	std::vector<PlaneEq<double>> walls;	/* Planos de la habitación */
+	std::vector<PlaneEq<float>> wallsFloat;	/* Planos de la habitación en precisión simple */
+	std::vector<Point> receptors;		/* Centros de los receptores */
+	std::vector<Vec3f> receptorsFloat;	/* Centros de los receptores en precisión simple */
+	bool singlePrecision;				/* Indica si los rayos se propagan en float en lugar de double */
+	double radio;						/* Radio de los receptores */
+	double binWidth;					/* Ancho de los intervalos de los histogramas en segundos */
+	double maxTime;						/* Duración máxima de la respuesta en segundos */
+	float loss;							/* Pérdida de energía por reflexión */
+	std::vector<Bands> reflectance;		/* Factor de energía reflejada por banda de cada material */
+	std::vector<float> scattering;		/* Coeficiente de dispersión de cada material */
+	double threshold;					/* Umbral relativo a la energía inicial del rayo para la ruleta rusa (0 la desactiva) */
+	double energyFloor;					/* Umbral absoluto de energía del bloque en curso */
+	Crossover crossover;				/* Transición con la parte temprana determinista (inactiva por defecto) */
+	Random rng;							/* Generador de la ruleta rusa y de la dispersión del bloque en curso */
+	std::vector<Histogram> histograms;	/* Histogramas de los receptores */
+	RayBatch batch;						/* Bloque de rayos en curso */
+	RayBatchT<float> batchFloat;		/* Bloque de rayos en curso en precisión simple */
+	long long raysTraced;				/* Rayos trazados */
+	long long reflections;				/* Reflexiones calculadas */
+	long long terminated;				/* Rayos terminados por la ruleta rusa */
+	long long hits;						/* Llegadas acumuladas en los histogramas de los receptores */
+	long long steps;					/* Avances de rayo calculados */
+	CheckpointWriter* checkpoints;		/* Puntos de control, que se toman entre dos pasadas de un bloque (puede ser nullptr) */
+
+	/**
+	 * @brief Constructor de la clase Tracer.
+	 * @param rm Habitación (se usan sus planos y su tabla de materiales)
+	 * @param rs Centros de los receptores
+	 * @param r Radio de los receptores
+	 * @param bw Ancho de los intervalos de los histogramas en segundos
+	 * @param maxT Duración máxima de la respuesta en segundos
+	 * @param chunkSize Número de rayos por bloque
+	 * @param th Umbral relativo de energía para la ruleta rusa (0 la desactiva)
+	 */
+	Tracer(Room& rm, const std::vector<Point>& rs, double r, double bw, double maxT, int chunkSize, double th = 0) {
+		room = &rm;
+		receptors = rs;
+		radio = r;
+		binWidth = bw;
+		maxTime = maxT;
+		loss = 0;
+		threshold = th;
+		energyFloor = 0;
+		raysTraced = 0;
+		reflections = 0;
+		terminated = 0;
+		hits = 0;
+		steps = 0;
+		singlePrecision = false;
+		checkpoints = nullptr;
+
+		for (int i = 0; i < room->numPlanes; i++) {
+			Vec3 n = room->planes[i].getNormal();
+			Point p = room->planes[i].points[0];
+			PlaneEq<double> w;
+			w.nx = n.x;
+			w.ny = n.y;
+			w.nz = n.z;
+			w.d = -(w.nx * p.x + w.ny * p.y + w.nz * p.z);
+			walls.push_back(w);
+
+			PlaneEq<float> f = { (float)w.nx, (float)w.ny, (float)w.nz, (float)w.d };
+			wallsFloat.push_back(f);
+		}
+		for (size_t r = 0; r < receptors.size(); r++) {
+			receptorsFloat.push_back(Vec3f(receptors[r]));
+		}
+
+		histograms.assign(receptors.size(), Histogram(binWidth, maxTime));
+		batch.reserve(chunkSize);
+		batchFloat.reserve(chunkSize);
+	}
+
+	/**
+	 * @brief Vacía los histogramas y los contadores para trazar otra fuente con la misma habitación.
+	 */
+	void reset() {
+		for (size_t i = 0; i < histograms.size(); i++) {
+			histograms[i].energy.assign(histograms[i].energy.size(), 0.0);
+		}
+		raysTraced = 0;
+		reflections = 0;
+		terminated = 0;
+		hits = 0;
+		steps = 0;
+	}
+
+	/**
+	 * @brief Traza todos los rayos de un emisor, bloque a bloque.
+	 * @param emitter Emisor de rayos
+	 */
+	void run(Emitter& emitter) {
+		PROFILE_ZONE("Tracer::run");
+		loss = emitter.loss;
+		energyFloor = threshold * emitter.energy / emitter.totalRays;
+
+		// La pérdida de la fuente y la absorción del material se combinan en un único factor por banda
+		reflectance.clear();
+		scattering.clear();
+		for (size_t m = 0; m < room->materials.size(); m++) {
+			reflectance.push_back(room->materials[m].absorption.complement() * (1.0f - loss));
+			scattering.push_back(room->materials[m].scattering);
+		}
+
+		// Un bloque restaurado de un punto de control se termina antes de emitir el siguiente
+		if (singlePrecision && batchFloat.count > 0) {
+			traceBatch(batchFloat, wallsFloat, receptorsFloat);
+		}
+		else if (!singlePrecision && batch.count > 0) {
+			traceBatch(batch, walls, receptors);
+		}
+
+		while (!emitter.done()) {
+			rng = Random::forStream(~emitter.seed, emitter.chunkIndex);
+			if (singlePrecision) {
+				raysTraced += emitter.emit(batchFloat);
+				traceBatch(batchFloat, wallsFloat, receptorsFloat);
+			}
+			else {
+				raysTraced += emitter.emit(batch);
+				traceBatch(batch, walls, receptors);
+			}
+		}
+	}
+
+	/**
+	 * @brief Propaga todos los rayos del bloque actual de doble precisión hasta que terminen.
+	 */
+	void traceBatch() {
+		traceBatch(batch, walls, receptors);
+	}
+
+	/**
+	 * @brief Propaga todos los rayos de un bloque hasta que terminen.
+	 * @param b Bloque de rayos
+	 * @param w Planos de la habitación con el tipo escalar del bloque
+	 * @param centres Centros de los receptores (Point o Vec3f)
+	 */
+	template <typename Real, typename Centre>
+	void traceBatch(RayBatchT<Real>& b, const std::vector<PlaneEq<Real>>& w, const std::vector<Centre>& centres) {
+		PROFILE_ZONE("Tracer::traceBatch");
+		long long r0 = reflections, t0 = terminated, h0 = hits, s0 = steps;
+		while (b.count > 0) {
+			steps += b.count;
+
+			// Primero el plano alcanzado por todos los rayos (vectorizable), después el resto de cada reflexión
+			nearestWalls(w.data(), (int)w.size(), b, 0, b.count);
+			for (int i = 0; i < b.count;) {
+				if (advance(b, w, centres, i)) {
+					i++;
+				}
+				else {
+					b.remove(i);
+				}
+			}
+
+			if (checkpoints) {
+				checkpoints->poll();
+			}
+		}
+
+		// Los contadores globales se actualizan una vez por bloque
+		Counters::add(REFLECTIONS, reflections - r0);
+		Counters::add(RAYS_TERMINATED, terminated - t0);
+		Counters::add(RECEPTOR_HITS, hits - h0);
+		Counters::add(STEPS, steps - s0);
+	}
+
+	/**
+	 * @brief Avanza un rayo hasta su siguiente reflexión. El plano alcanzado ya está calculado en el bloque.
+	 * @param b Bloque de rayos
+	 * @param walls Planos de la habitación con el tipo escalar del bloque
+	 * @param centres Centros de los receptores
+	 * @param i Índice del rayo en el bloque
+	 * @return `true` si el rayo sigue vivo, `false` si terminó
+	 */
+	template <typename Real, typename Centre>
+	bool advance(RayBatchT<Real>& b, const std::vector<PlaneEq<Real>>& walls, const std::vector<Centre>& centres, int i) {
+		int hit = b.wall[i];
+		if (hit == -1) {
+			return false;
+		}
+
+		Real ox = b.ox[i], oy = b.oy[i], oz = b.oz[i];
+		Real dx = b.dx[i], dy = b.dy[i], dz = b.dz[i];
+		Real tMin = b.hitTime[i];
+
+		// Receptores atravesados por el segmento
+		Real r2 = (Real)(radio * radio);
+		for (int r = 0; r < (int)centres.size(); r++) {
+			Real vx = centres[r].x - ox, vy = centres[r].y - oy, vz = centres[r].z - oz;
+			Real tc = vx * dx + vy * dy + vz * dz;
+			if (tc > 0 && tc < tMin && vx * vx + vy * vy + vz * vz - tc * tc < r2) {
+				double t = (b.distance[i] + tc) / V_SON;
+				double weight = b.diffuse[i] ? 1.0 : crossover.late(t);
+				if (weight > 0) {
+					histograms[r].add(t, weight == 1.0 ? b.energy[i] : b.energy[i] * (float)weight);
+					hits++;
+				}
+			}
+		}
+
+		// Material del triángulo alcanzado
+		const PlaneEq<Real>& w = walls[hit];
+		Real px = ox + dx * tMin, py = oy + dy * tMin, pz = oz + dz * tMin;
+		int triangle = room->planes[hit].triangleIndexAt(Point(px, py, pz));
+		triangle = triangle < room->numTriangles ? triangle : room->numTriangles - 1;
+		int material = room->triangleMaterials[hit * room->numTriangles + triangle];
+
+		// Reflexión especular o difusa
+		b.ox[i] = px;
+		b.oy[i] = py;
+		b.oz[i] = pz;
+		if (rng.nextDouble() < scattering[material]) {
+			double x, y, z;
+			rng.nextLambert(w.nx, w.ny, w.nz, x, y, z);
+			b.dx[i] = (Real)x;
+			b.dy[i] = (Real)y;
+			b.dz[i] = (Real)z;
+			b.diffuse[i] = 1;
+		}
+		else {
+			Real dn = w.nx * dx + w.ny * dy + w.nz * dz;
+			b.dx[i] = dx - 2 * dn * w.nx;
+			b.dy[i] = dy - 2 * dn * w.ny;
+			b.dz[i] = dz - 2 * dn * w.nz;
+		}
+		b.distance[i] += tMin;
+		b.energy[i] *= reflectance[material];
+		reflections++;
+
+		// La ruleta rusa usa la banda más energética para no terminar rayos que aún aportan en alguna banda
+		double peak = b.energy[i].peak();
+		if (peak < energyFloor) {
+			if (rng.nextDouble() * energyFloor >= peak) {
+				terminated++;
+				return false;
+			}
+			b.energy[i] *= Bands((float)(energyFloor / peak));
+		}
+
+		return b.distance[i] / V_SON < maxTime;
+	}
+
+	/**
+	 * @brief Guarda el estado del trazado en curso: generador, contadores, histogramas y bloque de rayos.
+	 */
+	void save(Checkpoint& c) const {
+		c.put(rng.state);
+		c.put(raysTraced);
+		c.put(reflections);
+		c.put(terminated);
+		c.put(hits);
+		c.put(steps);
+		for (size_t i = 0; i < histograms.size(); i++) {
+			c.putVector(histograms[i].energy);
+		}
+		batch.save(c);
+		batchFloat.save(c);
+	}
+
+	/**
+	 * @brief Restaura el estado guardado con save. Los factores que dependen del emisor se recalculan en run.
+	 * @return false si los datos no son válidos
+	 */
+	bool load(Checkpoint& c) {
+		c.get(rng.state);
+		c.get(raysTraced);
+		c.get(reflections);
+		c.get(terminated);
+		c.get(hits);
+		c.get(steps);
+		for (size_t i = 0; i < histograms.size(); i++) {
+			size_t size = histograms[i].energy.size();
+			if (c.getVector(histograms[i].energy) != size) {
+				c.ok = false;
+			}
+		}
+		return batch.load(c) && batchFloat.load(c);
+	}
+
+	/**
+	 * @brief Exporta los histogramas a un archivo CSV por banda, una fila por receptor.
+	 * @param prefix Prefijo de los archivos; se les añade la frecuencia central de la banda
+	 */
+	void exportCSV(const char* prefix) {
+		Histogram::exportCSV(prefix, histograms);
+	}
+};
+
+#endif // TRACER_H
@@ -0,0 +1,96 @@
+#ifndef TRANSFER_JOB_H
+#define TRANSFER_JOB_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "exportQueue.h"
+#include "room.h"
+
+/**
+ * @class TransferJob
+ * @brief Cálculo de la matriz de energía completa de una habitación en un hilo de fondo.
+ * @details La habitación se crea con la matriz aproximada (TRANSFER_APPROXIMATE) y se dibuja y simula desde el primer
+ * frame. El hilo calcula la matriz completa sobre una copia de los triángulos, sin tocar la habitación, y la deja en
+ * `result`; el hilo que mueve las partículas la toma con apply() entre dos pasos, así que el cambio es atómico para la
+ * simulación. `progress()` da la fracción de filas calculadas.
+ *
+ * Al destruirse cancela el cálculo (se comprueba en cada fila) y libera la matriz si no llegó a ponerse en la
+ * habitación.
+ */
+class TransferJob {
+public:
+	Room* room;						/* Habitación */
+	int rows;						/* Filas de la matriz */
+	std::atomic<int> done;			/* Filas calculadas */
+	std::atomic<double**> result;	/* Matriz completa, hasta que la toma apply() */
+	std::atomic<bool> applied;		/* Indica si la habitación ya usa la matriz completa */
+	std::atomic<bool> cancelled;	/* Pide al hilo que abandone el cálculo */
+	std::thread thread;				/* Hilo del cálculo */
+
+	TransferJob() : room(nullptr), rows(0), done(0), result(nullptr), applied(false), cancelled(false) {}
+
+	~TransferJob() {
+		cancelled.store(true, std::memory_order_relaxed);
+		if (thread.joinable()) {
+			thread.join();
+		}
+
+		double** matrix = result.exchange(nullptr, std::memory_order_acquire);
+		if (matrix) {
+			// La matriz terminada está prestada a la cola de exportación hasta que se escriba
+			ExportQueue::instance().wait();
+			for (int i = 0; i < rows; i++) {
+				delete[] matrix[i];
+			}
+			delete[] matrix;
+		}
+	}
+
+	/**
+	 * @brief Arranca el cálculo de la matriz completa de una habitación.
+	 * @param r Habitación creada con la matriz aproximada
+	 */
+	void start(Room* r) {
+		room = r;
+		std::vector<Triangle> triangles = room->indexTriangles();
+		rows = (int)triangles.size();
+		thread = std::thread([this, triangles]() {
+			double** matrix = new double* [rows];
+			if (room->transferMatrix(triangles, matrix, &done, true, &cancelled)) {
+				result.store(matrix, std::memory_order_release);
+			}
+			else {
+				delete[] matrix;
+			}
+		});
+	}
+
+	/**
+	 * @brief Pone la matriz completa en la habitación si ya está calculada. Solo debe llamarla el hilo que mueve las
+	 * partículas, entre dos pasos.
+	 * @return true si la matriz se ha puesto en esta llamada
+	 */
+	bool apply() {
+		if (!room || applied.load(std::memory_order_relaxed)) {
+			return false;
+		}
+		double** matrix = result.exchange(nullptr, std::memory_order_acquire);
+		if (!matrix) {
+			return false;
+		}
+		room->setTransfer(matrix);
+		applied.store(true, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @brief Fracción de filas calculadas, entre 0 y 1.
+	 */
+	double progress() const {
+		return rows > 0 ? (double)done.load(std::memory_order_relaxed) / rows : 0;
+	}
+};
+
+#endif // TRANSFER_JOB_H
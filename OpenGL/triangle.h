@@ -5,22 +5,23 @@
 
 #include "point.h"
 #include "vect.h"
+#include "vec3.h"
 
-const glm::vec4 DEFAULT_TRIANGLE_COLOR = glm::vec4(0.25, 0.78, 1, 0.1); /* Color por defecto de los tringulos */
+const glm::vec4 DEFAULT_TRIANGLE_COLOR = glm::vec4(0.25, 0.78, 1, 0.1); /* Color por defecto de los triángulos */
 
 /**
- * @brief Clase que representa un tringulo
- * @details Un tringulo se representa mediante tres puntos en el espacio
+ * @brief Clase que representa un triángulo
+ * @details Un triángulo se representa mediante tres puntos en el espacio
  * @see Point
  */
 class Triangle {
 private:
-	Point a; /* Punto A del tringulo */
-	Point b; /* Punto B del tringulo */
-	Point c; /* Punto C del tringulo */
-	std::string ID; /* Identificador del tringulo */
-	int index; /* ndice del tringulo */
-	glm::vec4 color; /* Color del tringulo */
+	Point a; /* Punto A del triángulo */
+	Point b; /* Punto B del triángulo */
+	Point c; /* Punto C del triángulo */
+	std::string ID; /* Identificador del triángulo */
+	int index; /* Índice del triángulo */
+	glm::vec4 color; /* Color del triángulo */
 public:
 	/**
 	 * @brief Constructor por defecto de la clase
@@ -47,11 +48,11 @@ public:
 
 	/**
 	 * @brief Constructor de la clase
-	 * @param aa Punto A del tringulo
-	 * @param bb Punto B del tringulo
-	 * @param cc Punto C del tringulo
-	 * @param id Identificador del tringulo
-	 * @param col Color del tringulo
+	 * @param aa Punto A del triángulo
+	 * @param bb Punto B del triángulo
+	 * @param cc Punto C del triángulo
+	 * @param id Identificador del triángulo
+	 * @param col Color del triángulo
 	 */
 	Triangle(const Point& aa, const Point& bb, const Point& cc, const std::string id) {
 		a = aa;
@@ -64,11 +65,11 @@ public:
 
 	/**
 	 * @brief Constructor de la clase
-	 * @param aa Punto A del tringulo
-	 * @param bb Punto B del tringulo
-	 * @param cc Punto C del tringulo
-	 * @param id Identificador del tringulo
-	 * @param col Color del tringulo
+	 * @param aa Punto A del triángulo
+	 * @param bb Punto B del triángulo
+	 * @param cc Punto C del triángulo
+	 * @param id Identificador del triángulo
+	 * @param col Color del triángulo
 	 */
 	Triangle(const Point& aa, const Point& bb, const Point& cc, const std::string id, const glm::vec4 col) {
 		a = aa;
@@ -92,24 +93,24 @@ public:
 		index = t.getIndex();
 	}
 
-	Point getA() const { return a; } /* Devuelve el punto A del tringulo */
-	Point getB() const { return b; } /* Devuelve el punto B del tringulo */
-	Point getC() const { return c; } /* Devuelve el punto C del tringulo */
-	std::string getID() const { return ID; } /* Devuelve el identificador del tringulo */
-	glm::vec4 getColor() const { return color; } /* Devuelve el color del tringulo */
-	int getIndex() const { return index; } /* Devuelve el ndice del tringulo */
+	Point getA() const { return a; } /* Devuelve el punto A del triángulo */
+	Point getB() const { return b; } /* Devuelve el punto B del triángulo */
+	Point getC() const { return c; } /* Devuelve el punto C del triángulo */
+	std::string getID() const { return ID; } /* Devuelve el identificador del triángulo */
+	glm::vec4 getColor() const { return color; } /* Devuelve el color del triángulo */
+	int getIndex() const { return index; } /* Devuelve el índice del triángulo */
 
-	void setA(const Point& aa) { a = aa; } /* Configura el punto A del tringulo */
-	void setB(const Point& bb) { b = bb; } /* Configura el punto B del tringulo */
-	void setC(const Point& cc) { c = cc; } /* Configura el punto C del tringulo */
-	void setID(const std::string id) { ID = id; } /* Configura el identificador del tringulo */
-	void setColor(const glm::vec4 col) { color = col; } /* Configura el color del tringulo */
-	void setIndex(const int i) { index = i; } /* Configura el ndice del tringulo */
+	void setA(const Point& aa) { a = aa; } /* Configura el punto A del triángulo */
+	void setB(const Point& bb) { b = bb; } /* Configura el punto B del triángulo */
+	void setC(const Point& cc) { c = cc; } /* Configura el punto C del triángulo */
+	void setID(const std::string id) { ID = id; } /* Configura el identificador del triángulo */
+	void setColor(const glm::vec4 col) { color = col; } /* Configura el color del triángulo */
+	void setIndex(const int i) { index = i; } /* Configura el índice del triángulo */
 
 	/**
 	 * @brief Sobrecarga del operador de igualdad.
-	 * @param t tringulo a comparar.
-	 * @return `true` si los tringulos son iguales, `false` en caso contrario.
+	 * @param t triángulo a comparar.
+	 * @return `true` si los triángulos son iguales, `false` en caso contrario.
 	 */
 	int operator==(const Triangle& t) const {
 		return a == t.getA() && b == t.getB() && c == t.getC() ? 1 : 0;
@@ -117,17 +118,17 @@ public:
 
 	/**
 	 * @brief Sobrecarga del operador de desigualdad.
-	 * @param t tringulo a comparar.
-	 * @return `true` si los tringulos son distintos, `false` en caso contrario.
+	 * @param t triángulo a comparar.
+	 * @return `true` si los triángulos son distintos, `false` en caso contrario.
 	 */
 	bool operator!=(const Triangle& t) const {
 		return a != t.getA() || b != t.getB() || c != t.getC() ? 1 : 0;
 	}
 
 	/**
-	 * @brief Sobrecarga del operador de asignacin.
-	 * @param t tringulo a asignar.
-	 * @return Referencia al tringulo.
+	 * @brief Sobrecarga del operador de asignación.
+	 * @param t triángulo a asignar.
+	 * @return Referencia al triángulo.
 	 */
 	Triangle& operator=(const Triangle& t) {
 		a = t.getA();
@@ -140,20 +141,16 @@ public:
 	}
 
 	/**
-	 * @brief Devuelve el vector normal del tringulo
-	 * @return Vect
+	 * @brief Devuelve el vector normal unitario del triángulo
+	 * @return Vec3
 	 */
-	Vect getNormal() const {
-		Vect v1(a, b);
-		Vect v2(a, c);
-		Point n = (v1 ^ v2).unit().asPoint();
-		Point start = getBarycenter();
-		return Vect(start, start + n);
+	Vec3 getNormal() const {
+		return Vec3::between(a, b).cross(Vec3::between(a, c)).unit();
 	}
 
 
 	/**
-	 * @brief Devuelve el baricentro del tringulo
+	 * @brief Devuelve el baricentro del triángulo
 	 * @return Point
 	 */
 	Point getBarycenter() const {
@@ -161,37 +158,24 @@ public:
 	}
 
 	/**
-	 * @brief Comprueba si un punto est dentro del tringulo
+	 * @brief Comprueba si un punto está dentro del triángulo
 	 * @param p
 	 * @return int
 	 */
 	int isInside(const Point& p) const {
-		Vect v1(a, b);
-		Vect v2(a, c);
-		Vect v3(a, p);
-		Vect n = v1 ^ v2;
-		double d = n * v3;
-		return d > 0 ? 1 : 0;
+		return isPointInside(p) ? 1 : 0;
 	}
 
 	/**
-	 * @brief rea del tringulo
+	 * @brief Área del triángulo
 	 * @return double
 	 */
 	double area() const {
-		Vect v1(a, b);
-		Vect v2(a, c);
-		Vect n = v1 ^ v2;
-		return n.length() / 2.0;
+		return Vec3::between(a, b).cross(Vec3::between(a, c)).length() / 2.0;
 	}
 
 	bool isPointInside(const Point& p) const {
-		Vect v1(a, b);
-		Vect v2(a, c);
-		Vect v3(a, p);
-		Vect n = v1 ^ v2;
-		double d = n * v3;
-		return d > 0 ? true : false;
+		return Vec3::between(a, b).cross(Vec3::between(a, c)).dot(Vec3::between(a, p)) > 0;
 	}
 
 	/**
@@ -204,9 +188,9 @@ public:
 	}
 
 	/**
-	 * @brief Sobrecarga del operador de insercin en flujo de salida.
+	 * @brief Sobrecarga del operador de inserción en flujo de salida.
 	 * @param os Flujo de salida.
-	 * @param t tringulo a imprimir.
+	 * @param t triángulo a imprimir.
 	 * @return Referencia al flujo de salida.
 	 */
 	friend std::ostream& operator<<(std::ostream& os, const Triangle& t) {
@@ -0,0 +1,154 @@
+#ifndef VEC3_H
+#define VEC3_H
+
+#include <cmath>
+#include <ostream>
+#include <type_traits>
+
+#include "point.h"
+
+/**
+ * @class Vector3
+ * @brief Vector libre de tres componentes, con el tipo escalar como parámetro.
+ * @details A diferencia de Vect no guarda un punto inicial: ocupa tres escalares, se copia con memcpy (trivialmente
+ * copiable) y las operaciones aritméticas son constexpr. Es el tipo que usan las rutas de cálculo de la geometría;
+ * Vect queda como adaptador para el código que todavía lo usa. Vec3 (double) se usa en el precálculo y en la
+ * acumulación; Vec3f (float) en el trazado masivo en precisión simple.
+ */
+template <typename T>
+class Vector3 {
+public:
+	T x; /* Componente i */
+	T y; /* Componente j */
+	T z; /* Componente k */
+
+	/**
+	 * @brief Vector nulo.
+	 */
+	constexpr Vector3() : x(0), y(0), z(0) {}
+
+	/**
+	 * @brief Vector dadas sus componentes.
+	 */
+	constexpr Vector3(T xx, T yy, T zz) : x(xx), y(yy), z(zz) {}
+
+	/**
+	 * @brief Vector desde el origen hasta un punto.
+	 */
+	constexpr explicit Vector3(const Point& p) : x((T)p.x), y((T)p.y), z((T)p.z) {}
+
+	/**
+	 * @brief Conversión entre precisiones.
+	 */
+	template <typename U>
+	constexpr explicit Vector3(const Vector3<U>& v) : x((T)v.x), y((T)v.y), z((T)v.z) {}
+
+	/**
+	 * @brief Vector que va de un punto a otro. La resta se hace en double y después se redondea a T.
+	 */
+	static constexpr Vector3 between(const Point& from, const Point& to) {
+		return Vector3((T)(to.x - from.x), (T)(to.y - from.y), (T)(to.z - from.z));
+	}
+
+	constexpr Vector3 operator+(const Vector3& v) const { return Vector3(x + v.x, y + v.y, z + v.z); }
+	constexpr Vector3 operator-(const Vector3& v) const { return Vector3(x - v.x, y - v.y, z - v.z); }
+	constexpr Vector3 operator-() const { return Vector3(-x, -y, -z); }
+	constexpr Vector3 operator*(T f) const { return Vector3(x * f, y * f, z * f); }
+	constexpr Vector3 operator/(T f) const { return Vector3(x / f, y / f, z / f); }
+
+	Vector3& operator+=(const Vector3& v) { x += v.x; y += v.y; z += v.z; return *this; }
+	Vector3& operator-=(const Vector3& v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+	Vector3& operator*=(T f) { x *= f; y *= f; z *= f; return *this; }
+
+	constexpr bool operator==(const Vector3& v) const { return x == v.x && y == v.y && z == v.z; }
+	constexpr bool operator!=(const Vector3& v) const { return !(*this == v); }
+
+	/**
+	 * @brief Producto escalar.
+	 */
+	constexpr T dot(const Vector3& v) const {
+		return x * v.x + y * v.y + z * v.z;
+	}
+
+	/**
+	 * @brief Producto vectorial.
+	 */
+	constexpr Vector3 cross(const Vector3& v) const {
+		return Vector3(y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x);
+	}
+
+	/**
+	 * @brief Cuadrado de la norma; evita la raíz cuando solo se comparan longitudes.
+	 */
+	constexpr T lengthSquared() const {
+		return x * x + y * y + z * z;
+	}
+
+	/**
+	 * @brief Norma del vector.
+	 */
+	T length() const {
+		return std::sqrt(lengthSquared());
+	}
+
+	/**
+	 * @brief Vector unitario con la misma dirección, con una sola raíz y una sola división.
+	 */
+	Vector3 unit() const {
+		return *this * (T(1) / length());
+	}
+
+	/**
+	 * @brief Reflejo respecto a un plano de normal unitaria n: v - 2 (v . n) n.
+	 */
+	constexpr Vector3 reflect(const Vector3& n) const {
+		return *this - n * (2 * dot(n));
+	}
+
+	/**
+	 * @brief Punto p + t * v, sin construir vectores intermedios.
+	 */
+	constexpr Point along(const Point& p, double t) const {
+		return Point(p.x + x * t, p.y + y * t, p.z + z * t);
+	}
+
+	/**
+	 * @brief Punto con las mismas coordenadas que el vector.
+	 */
+	constexpr Point asPoint() const {
+		return Point(x, y, z);
+	}
+
+	/**
+	 * @brief Rota el vector alrededor de un eje unitario k un ángulo theta (fórmula de Rodrigues).
+	 * @param k Eje de rotación unitario
+	 * @param theta Ángulo en radianes
+	 */
+	Vector3 rotate(const Vector3& k, double theta) const {
+		T c = std::cos((T)theta);
+		return *this * c + k.cross(*this) * std::sin((T)theta) + k * (k.dot(*this) * (1 - c));
+	}
+
+	friend std::ostream& operator<<(std::ostream& os, const Vector3& v) {
+		os << "Vector3(" << v.x << ", " << v.y << ", " << v.z << ")";
+		return os;
+	}
+};
+
+typedef Vector3<double> Vec3;	/* Vector en doble precisión */
+typedef Vector3<float> Vec3f;	/* Vector en precisión simple */
+
+static_assert(std::is_trivially_copyable<Vec3>::value, "Vec3 debe ser trivialmente copiable");
+static_assert(std::is_trivially_copyable<Vec3f>::value, "Vec3f debe ser trivialmente copiable");
+static_assert(std::is_trivially_copyable<Point>::value, "Point debe ser trivialmente copiable");
+static_assert(Vec3(1, 0, 0).cross(Vec3(0, 1, 0)) == Vec3(0, 0, 1), "Vec3::cross debe poder evaluarse en compilación");
+
+/**
+ * @brief Desplaza un punto según un vector.
+ */
+template <typename T>
+constexpr Point operator+(const Point& p, const Vector3<T>& v) {
+	return Point(p.x + v.x, p.y + v.y, p.z + v.z);
+}
+
+#endif // VEC3_H
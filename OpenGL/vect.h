@@ -4,10 +4,13 @@
 #include <ostream>
 
 #include "point.h"
+#include "vec3.h"
 
 /**
  * @class Vect
  * @brief Representa un vector en el espacio tridimensional.
+ * @details Guarda el punto inicial y el final. Los cálculos de la geometría usan Vec3; Vect se mantiene como
+ * adaptador y se convierte a Vec3 (su dirección) de forma implícita.
  */
 class Vect {
 public:
@@ -41,6 +44,15 @@ public:
 		p2 = pp2;
 	}
 
+	/**
+	 * @brief Vector libre con origen en el origen de coordenadas.
+	 * @param v Componentes del vector.
+	 */
+	Vect(const Vec3& v) {
+		p1 = Point();
+		p2 = v.asPoint();
+	}
+
 	/**
 	 * @brief Constructor de copia.
 	 * @param v Vector a copiar.
@@ -59,6 +71,13 @@ public:
 	double getJ() const { return p2.y - p1.y; } /* Devuelve la componente j del vector */
 	double getK() const { return p2.z - p1.z; } /* Devuelve la componente k del vector */
 
+	/**
+	 * @brief Dirección del vector como Vec3.
+	 */
+	operator Vec3() const {
+		return Vec3::between(p1, p2);
+	}
+
 	/**
 	 * @brief Cambia el punto inicial del vector. El punto final se actualiza en consecuencia.
 	 * @param p Punto inicial del vector.
@@ -87,7 +106,7 @@ public:
 	}
 
 	/**
-	 * @brief Sobrecarga del operador de asignacin.
+	 * @brief Sobrecarga del operador de asignación.
 	 * @param v Vector a asignar.
 	 * @return Devuelve el vector asignado.
 	*/
@@ -124,7 +143,7 @@ public:
 	}
 
 	/**
-	 * @brief Sobrecarga del operador de multiplicacin por un escalar.
+	 * @brief Sobrecarga del operador de multiplicación por un escalar.
 	 * @param f Escalar a multiplicar.
 	 * @return Devuelve el vector multiplicado por el escalar.
 	*/
@@ -133,7 +152,7 @@ public:
 	}
 
 	/**
-	 * @brief Sobrecarga del operador de divisin por un escalar.
+	 * @brief Sobrecarga del operador de división por un escalar.
 	 * @param f Escalar a dividir.
 	 * @return Devuelve el vector dividido por el escalar.
 	*/
@@ -147,12 +166,7 @@ public:
 	 * @return Devuelve el producto escalar.
 	*/
 	double operator*(const Vect& v) const {
-		Point u = asPoint();
-		Point V = v.asPoint();
-		double dotx = u.x * V.x;
-		double doty = u.y * V.y;
-		double dotz = u.z * V.z;
-		return dotx + doty + dotz;
+		return Vec3::between(p1, p2).dot(Vec3::between(v.p1, v.p2));
 	}
 
 	/**
@@ -161,12 +175,7 @@ public:
 	 * @return Devuelve el producto vectorial.
 	 */
 	Vect operator^(const Vect& v) const {
-		Point u = asPoint();
-		Point V = v.asPoint();
-		double crossx = u.y * V.z - u.z * V.y;
-		double crossy = u.z * V.x - u.x * V.z;
-		double crossz = u.x * V.y - u.y * V.x;
-		return Vect(Point(crossx, crossy, crossz));
+		return Vect(Vec3::between(p1, p2).cross(Vec3::between(v.p1, v.p2)));
 	}
 
 	/**
@@ -182,7 +191,7 @@ public:
 	 * @return Devuelve la longitud del vector.
 	 */
 	double length() const {
-		return sqrt(pow(getI(), 2) + pow(getJ(), 2) + pow(getK(), 2));
+		return Vec3::between(p1, p2).length();
 	}
 
 	Vect perpendicular() const {
@@ -197,22 +206,23 @@ public:
 	 * @return Devuelve el vector unitario.
 	 */
 	Vect unit() const {
-		return Vect(p1 / length(), p2 / length());
+		double l = length();
+		return Vect(p1 / l, p2 / l);
 	}
 
 	/**
-	 * @brief Devuelve el ngulo entre dos vectores.
+	 * @brief Devuelve el ángulo entre dos vectores.
 	 * @param v Vector a comparar.
-	 * @return ngulo entre dos vectores.
+	 * @return Ángulo entre dos vectores.
 	 */
 	double angle(const Vect& v) const {
 		return acos((*this * v) / (length() * v.length()));
 	}
 
 	/**
-	 * @brief Devuelve el vector proyeccin de un vector sobre otro.
+	 * @brief Devuelve el vector proyección de un vector sobre otro.
 	 * @param v Vector a proyectar.
-	 * @return Vector proyeccin.
+	 * @return Vector proyección.
 	 */
 	Vect proy(const Vect& v) const {
 		return v.unit() * ((*this * v) / v.length());
@@ -228,7 +238,7 @@ public:
 	}
 
 	/**
-	 * @brief Sobrecarga del operador de insercin en flujo de salida.
+	 * @brief Sobrecarga del operador de inserción en flujo de salida.
 	 * @param os Flujo de salida.
 	 * @param v Vector a insertar.
 	 * @return Referencia al flujo de salida.
@@ -239,10 +249,10 @@ public:
 	}
 
 	/**
-	 * @brief Rota un vector alrededor de un eje en un ngulo theta usando la frmula de Rodrigues.
+	 * @brief Rota un vector alrededor de un eje en un ángulo theta usando la fórmula de Rodrigues.
 	 * @param k Vector eje. El vector puede o no ser unitario debido a que se normaliza.
 	 * @param v Vector a rotar (no necesita ser unitario).
-	 * @param theta ngulo de rotacin en radianes.
+	 * @param theta Ángulo de rotación en radianes.
 	 * @return Vector rotado.
 	 *
 	 * @note https://en.wikipedia.org/wiki/Rodrigues%27_rotation_formula
@@ -257,10 +267,10 @@ public:
 
 
 	/**
-	 * @brief [Deprecated] Rota un vector alrededor de un eje dado un ngulo theta.
+	 * @brief [Deprecated] Rota un vector alrededor de un eje dado un ángulo theta.
 	 * @param u Vector eje.
 	 * @param v Vector a rotar.
-	 * @param theta ngulo de rotacin.
+	 * @param theta Ángulo de rotación.
 	 * @return Vector rotado.
 	 *
 	 */
@@ -0,0 +1,257 @@
+#ifndef WAV_H
+#define WAV_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <cstring>
+#include <vector>
+
+/**
+ * @class WavReader
+ * @brief Lector de archivos WAV por bloques.
+ * @details Admite PCM de 8, 16, 24 y 32 bits y coma flotante de 32 bits, también en formato extensible. Las
+ * muestras se devuelven en coma flotante en [-1, 1] y, si hay varios canales, se mezclan a mono.
+ */
+class WavReader {
+public:
+	FILE* file;				/* Archivo abierto */
+	int sampleRate;			/* Frecuencia de muestreo en Hz */
+	int channels;			/* Número de canales */
+	int bitsPerSample;		/* Bits por muestra */
+	bool floating;			/* Indica si las muestras son de coma flotante */
+	long long frames;		/* Número total de tramas */
+	long long remaining;	/* Tramas que quedan por leer */
+	std::vector<unsigned char> raw;	/* Memoria intermedia de lectura */
+
+	WavReader() : file(nullptr), sampleRate(0), channels(0), bitsPerSample(0), floating(false), frames(0), remaining(0) {}
+
+	/**
+	 * @brief Abre un archivo WAV y lee su cabecera.
+	 * @param filename Nombre del archivo
+	 */
+	explicit WavReader(const char* filename) : WavReader() {
+		open(filename);
+	}
+
+	~WavReader() {
+		close();
+	}
+
+	WavReader(const WavReader&) = delete;
+	WavReader& operator=(const WavReader&) = delete;
+
+	/**
+	 * @brief Abre un archivo WAV y se sitúa al principio de sus muestras.
+	 * @param filename Nombre del archivo
+	 * @return `true` si el archivo es un WAV admitido
+	 */
+	bool open(const char* filename) {
+		close();
+		if (fopen_s(&file, filename, "rb") != 0) {
+			file = nullptr;
+			perror("Error al abrir el archivo");
+			return false;
+		}
+
+		unsigned char header[12];
+		if (fread(header, 1, 12, file) != 12 || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+			close();
+			return false;
+		}
+
+		bool format = false;
+		unsigned char chunk[8];
+		while (fread(chunk, 1, 8, file) == 8) {
+			uint32_t size = readU32(chunk + 4);
+			if (memcmp(chunk, "fmt ", 4) == 0) {
+				std::vector<unsigned char> fmt(size);
+				if (size < 16 || fread(fmt.data(), 1, size, file) != size) break;
+				int tag = readU16(&fmt[0]);
+				channels = readU16(&fmt[2]);
+				sampleRate = (int)readU32(&fmt[4]);
+				bitsPerSample = readU16(&fmt[14]);
+				if (tag == 0xFFFE && size >= 26) {
+					tag = readU16(&fmt[24]);	// Primeros bytes del subformato
+				}
+				floating = tag == 3;
+				format = (tag == 1 || (tag == 3 && bitsPerSample == 32)) && channels > 0;
+				if (size % 2) fseek(file, 1, SEEK_CUR);
+			}
+			else if (memcmp(chunk, "data", 4) == 0) {
+				if (!format) break;
+				frames = size / (channels * (bitsPerSample / 8));
+				remaining = frames;
+				return true;
+			}
+			else {
+				fseek(file, size + (size % 2), SEEK_CUR);
+			}
+		}
+
+		close();
+		return false;
+	}
+
+	/**
+	 * @brief Indica si hay un archivo abierto.
+	 */
+	bool valid() const {
+		return file != nullptr;
+	}
+
+	/**
+	 * @brief Lee el siguiente bloque de tramas mezclado a mono.
+	 * @param out Destino de las muestras
+	 * @param count Número máximo de tramas
+	 * @return Tramas leídas; 0 al final del archivo
+	 */
+	int read(float* out, int count) {
+		if (!file || remaining <= 0) {
+			return 0;
+		}
+		count = (int)(count < remaining ? count : remaining);
+		int bytes = bitsPerSample / 8;
+		raw.resize((size_t)count * channels * bytes);
+		int got = (int)(fread(raw.data(), (size_t)channels * bytes, count, file));
+		remaining = got < count ? 0 : remaining - got;
+
+		float scale = 1.0f / channels;
+		for (int i = 0; i < got; i++) {
+			float sum = 0;
+			for (int c = 0; c < channels; c++) {
+				sum += sample(&raw[((size_t)i * channels + c) * bytes]);
+			}
+			out[i] = sum * scale;
+		}
+		return got;
+	}
+
+	/**
+	 * @brief Cierra el archivo.
+	 */
+	void close() {
+		if (file) {
+			fclose(file);
+			file = nullptr;
+		}
+	}
+
+private:
+	float sample(const unsigned char* p) const {
+		switch (bitsPerSample) {
+		case 8: return (p[0] - 128) / 128.0f;
+		case 16: return (int16_t)readU16(p) / 32768.0f;
+		case 24: return (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24) / 2147483648.0f;
+		default:
+			if (floating) {
+				float f;
+				memcpy(&f, p, 4);
+				return f;
+			}
+			return (int32_t)readU32(p) / 2147483648.0f;
+		}
+	}
+
+	static uint16_t readU16(const unsigned char* p) {
+		return (uint16_t)(p[0] | p[1] << 8);
+	}
+
+	static uint32_t readU32(const unsigned char* p) {
+		return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+	}
+};
+
+/**
+ * @class WavWriter
+ * @brief Escritor de archivos WAV mono en coma flotante de 32 bits por bloques.
+ * @details La cabecera se escribe al abrir con tamaños provisionales y se completa al cerrar, así que la memoria
+ * usada no depende de la duración.
+ */
+class WavWriter {
+public:
+	FILE* file;				/* Archivo abierto */
+	int sampleRate;			/* Frecuencia de muestreo en Hz */
+	long long frames;		/* Tramas escritas */
+
+	WavWriter() : file(nullptr), sampleRate(0), frames(0) {}
+
+	~WavWriter() {
+		close();
+	}
+
+	WavWriter(const WavWriter&) = delete;
+	WavWriter& operator=(const WavWriter&) = delete;
+
+	/**
+	 * @brief Crea un archivo WAV y escribe su cabecera provisional.
+	 * @param filename Nombre del archivo
+	 * @param rate Frecuencia de muestreo en Hz
+	 * @return `true` si se pudo crear el archivo
+	 */
+	bool open(const char* filename, int rate) {
+		close();
+		if (fopen_s(&file, filename, "wb") != 0) {
+			file = nullptr;
+			perror("Error al abrir el archivo");
+			return false;
+		}
+		sampleRate = rate;
+		frames = 0;
+		writeHeader();
+		return true;
+	}
+
+	/**
+	 * @brief Añade un bloque de muestras al archivo.
+	 * @param samples Muestras
+	 * @param count Número de muestras
+	 */
+	void write(const float* samples, int count) {
+		if (file) {
+			frames += fwrite(samples, sizeof(float), count, file);
+		}
+	}
+
+	/**
+	 * @brief Completa la cabecera con los tamaños finales y cierra el archivo.
+	 */
+	void close() {
+		if (file) {
+			fseek(file, 0, SEEK_SET);
+			writeHeader();
+			fclose(file);
+			file = nullptr;
+		}
+	}
+
+private:
+	void writeHeader() {
+		uint32_t data = (uint32_t)(frames * sizeof(float));
+		unsigned char h[44];
+		memcpy(h, "RIFF", 4);
+		putU32(h + 4, 36 + data);
+		memcpy(h + 8, "WAVEfmt ", 8);
+		putU32(h + 16, 16);
+		putU16(h + 20, 3);					// Coma flotante
+		putU16(h + 22, 1);					// Mono
+		putU32(h + 24, sampleRate);
+		putU32(h + 28, sampleRate * sizeof(float));
+		putU16(h + 32, sizeof(float));
+		putU16(h + 34, 32);
+		memcpy(h + 36, "data", 4);
+		putU32(h + 40, data);
+		fwrite(h, 1, 44, file);
+	}
+
+	static void putU16(unsigned char* p, uint32_t v) {
+		p[0] = v & 0xFF;
+		p[1] = (v >> 8) & 0xFF;
+	}
+
+	static void putU32(unsigned char* p, uint32_t v) {
+		putU16(p, v & 0xFFFF);
+		putU16(p + 2, v >> 16);
+	}
+};
+
+#endif // WAV_H